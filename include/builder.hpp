@@ -0,0 +1,86 @@
+/**
+ * @file builder.hpp
+ *
+ */
+
+#pragma once
+
+#include "problem.hpp"
+
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace cvx
+{
+    /**
+     * @brief Builds a problem from multiple threads.
+     *
+     * @details Constraints and cost terms are collected in a separate buffer per thread, so threads do not
+     * wait for each other while the model is generated. commit() appends all buffers to the problem.
+     * The constraints of one thread keep their order, the buffers are appended in the order in which the
+     * threads first used the builder. Variables are created in the problem directly, guarded by a lock.
+     *
+     * All methods except commit() may be called concurrently. commit() must not run concurrently with
+     * any other method. Buffers that have not been committed are discarded with the builder.
+     */
+    class ProblemBuilder
+    {
+    public:
+        /**
+         * @brief Create a builder for a problem.
+         *
+         * @param problem The problem that receives the constraints on commit(). It must outlive the builder.
+         */
+        explicit ProblemBuilder(OptimizationProblem &problem);
+
+        ProblemBuilder(const ProblemBuilder &) = delete;
+        ProblemBuilder &operator=(const ProblemBuilder &) = delete;
+
+        /**
+         * @brief Creates variables in the problem. See OptimizationProblem::addVariable().
+         *
+         */
+        Scalar addVariable(const std::string &name);
+        VectorX addVariable(const std::string &name, size_t rows);
+        MatrixX addVariable(const std::string &name, size_t rows, size_t cols);
+
+        /**
+         * @brief Add constraints to the buffer of the calling thread.
+         *
+         * @return ConstraintHandle A handle that is valid once the constraints have been committed
+         */
+        ConstraintHandle addConstraint(const Constraint &constraint);
+        ConstraintHandle addConstraint(const std::vector<Constraint> &constraints);
+
+        /**
+         * @brief Add a cost term to the buffer of the calling thread.
+         *
+         * @param term A scalar cost term
+         */
+        void addCostTerm(const Scalar &term);
+
+        /**
+         * @brief Append the buffers of all threads to the problem and clear them.
+         *
+         */
+        void commit();
+
+    private:
+        OptimizationProblem &problem;
+
+        // Identifies the builder in the cache of each thread, since addresses may be reused
+        const size_t id;
+
+        std::mutex mutex;
+        std::vector<std::unique_ptr<OptimizationProblem>> buffers;
+        std::unordered_map<std::thread::id, OptimizationProblem *> thread_buffers;
+
+        /**
+         * @brief Returns the buffer of the calling thread and creates it on first use.
+         *
+         */
+        OptimizationProblem &getBuffer();
+    };
+
+} // namespace cvx
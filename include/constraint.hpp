@@ -14,15 +14,29 @@ namespace cvx
     namespace internal
     {
 
+        struct ConstraintSource
+        {
+            bool enabled = true;
+            // The number of constraints that have been added with this source
+            size_t num_constraints = 0;
+        };
+
         struct EqualityConstraint
         {
             Affine affine;
+            std::shared_ptr<ConstraintSource> source;
             friend std::ostream &operator<<(std::ostream &os, const EqualityConstraint &constraint);
         };
 
+        /**
+         * @brief The constraint sum(piecewise_linear) <= affine.
+         * 
+         */
         struct PositiveConstraint
         {
             Affine affine;
+            std::vector<PiecewiseLinear> piecewise_linear;
+            std::shared_ptr<ConstraintSource> source;
             friend std::ostream &operator<<(std::ostream &os, const PositiveConstraint &constraint);
         };
 
@@ -31,6 +45,7 @@ namespace cvx
             Affine lower;
             Affine middle;
             Affine upper;
+            std::shared_ptr<ConstraintSource> source;
             friend std::ostream &operator<<(std::ostream &os, const BoxConstraint &constraint);
         };
 
@@ -38,9 +53,23 @@ namespace cvx
         {
             std::vector<Affine> norm;
             Affine affine;
+            std::shared_ptr<ConstraintSource> source;
             friend std::ostream &operator<<(std::ostream &os, const SecondOrderConeConstraint &constraint);
         };
 
+        /**
+         * @brief The rotated cone norm^2 <= first_factor * second_factor with nonnegative factors.
+         * 
+         */
+        struct RotatedSecondOrderConeConstraint
+        {
+            std::vector<Affine> norm;
+            Affine first_factor;
+            Affine second_factor;
+            std::shared_ptr<ConstraintSource> source;
+            friend std::ostream &operator<<(std::ostream &os, const RotatedSecondOrderConeConstraint &constraint);
+        };
+
     } // namespace internal
 
     class Constraint
@@ -51,7 +80,8 @@ namespace cvx
             Equality,
             Positive,
             Box,
-            SecondOrderCone
+            SecondOrderCone,
+            RotatedSecondOrderCone
         };
 
         Type getType() const;
@@ -67,17 +97,62 @@ namespace cvx
 
     private:
         void asEquality(const internal::Affine &affine);
-        void asPositive(const internal::Affine &affine);
+        void asPositive(const internal::Affine &affine,
+                        const std::vector<internal::PiecewiseLinear> &piecewise_linear = {});
         void asBox(const internal::Affine &lower, const internal::Affine &middle, const internal::Affine &upper);
         void asSecondOrderCone(const std::vector<internal::Affine> &norm, const internal::Affine &affine);
+        void asRotatedSecondOrderCone(const std::vector<internal::Affine> &norm,
+                                      const internal::Affine &first_factor,
+                                      const internal::Affine &second_factor);
 
         using constraint_variant_t = std::variant<internal::EqualityConstraint,
                                                   internal::PositiveConstraint,
                                                   internal::BoxConstraint,
-                                                  internal::SecondOrderConeConstraint>;
+                                                  internal::SecondOrderConeConstraint,
+                                                  internal::RotatedSecondOrderConeConstraint>;
         constraint_variant_t data;
     };
 
+    /**
+     * @brief A handle to one or more constraints that have been added to a problem.
+     * 
+     * @details Disabling a constraint relaxes its rows in the solver data instead of removing them.
+     * The problem structure stays the same, so toggling a constraint only changes the bounds
+     * that are passed to the solver on the next solve.
+     */
+    class ConstraintHandle
+    {
+    public:
+        ConstraintHandle() = default;
+
+        /**
+         * @brief Enable the constraints again.
+         * 
+         */
+        void enable();
+
+        /**
+         * @brief Relax the constraints so they have no effect on the solution.
+         * 
+         */
+        void disable();
+
+        /**
+         * @brief Enable or disable the constraints.
+         * 
+         * @param enabled True to enable the constraints
+         */
+        void setEnabled(bool enabled);
+
+        bool isEnabled() const;
+
+        friend OptimizationProblem;
+        friend internal::WrapperBase;
+
+    private:
+        std::shared_ptr<internal::ConstraintSource> source;
+    };
+
     /**
      * @brief Create an equality constraint: lhs == rhs
      * 
@@ -99,6 +174,10 @@ namespace cvx
     /**
      * @brief Create a less than or equal constraint: lhs <= rhs
      * 
+     * @details If lhs is a sum of squares and rhs is linear or the product of two linear terms,
+     * as in ||x||^2 <= t * s, a rotated second order cone is created. Piecewise linear terms
+     * like norm1() on the left hand side are replaced with slack variables by the solver.
+     * 
      * @param lhs The left hand side
      * @param rhs The right hand side
      * @return Constraint The constraint to pass to addConstraint()
@@ -7,6 +7,10 @@
  */
 #pragma once
 
+#include "operators.hpp"
+#include "horizon.hpp"
+#include "builder.hpp"
+
 #ifdef ENABLE_ECOS
 #include "wrappers/ecosWrapper.hpp"
 #undef CTRLC
@@ -18,4 +22,5 @@
 
 #ifdef ENABLE_OSQP
 #include "wrappers/osqpWrapper.hpp"
+#include "wrappers/osqpBatchSolver.hpp"
 #endif
\ No newline at end of file
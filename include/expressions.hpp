@@ -44,6 +44,7 @@ namespace cvx
     namespace internal
     {
         class Affine;
+        class WrapperBase;
         class SOCPWrapperBase;
         class QPWrapperBase;
 
@@ -111,6 +112,53 @@ namespace cvx
             std::vector<Affine> factors;
         };
 
+        /**
+         * @brief The quadratic form x' * Q * x.
+         * 
+         * @details Only the upper triangular part of Q is stored. Each element of x
+         * contains at most one variable.
+         */
+        class QuadForm
+        {
+        public:
+            QuadForm(const std::vector<Affine> &x, const Eigen::SparseMatrix<Parameter> &Q);
+            double evaluate() const;
+
+            bool operator==(const QuadForm &other) const;
+
+            friend std::ostream &operator<<(std::ostream &os, const QuadForm &quad_form);
+
+            std::vector<Affine> x;
+            Eigen::SparseMatrix<Parameter> Q;
+        };
+
+        /**
+         * @brief A convex piecewise linear function of affine terms, scaled with a weight.
+         * 
+         * @details Max is the largest of the terms, Norm1 is the sum of their absolute values.
+         * The solver wrappers replace it with slack variables and inequality rows.
+         */
+        class PiecewiseLinear
+        {
+        public:
+            enum class Type
+            {
+                Max,
+                Norm1
+            };
+
+            PiecewiseLinear(Type type, const std::vector<Affine> &terms);
+            double evaluate() const;
+
+            bool operator==(const PiecewiseLinear &other) const;
+
+            friend std::ostream &operator<<(std::ostream &os, const PiecewiseLinear &piecewise_linear);
+
+            Type type;
+            std::vector<Affine> terms;
+            Parameter weight = Parameter(1.);
+        };
+
     } // namespace internal
 
     class Scalar
@@ -137,7 +185,14 @@ namespace cvx
         size_t getOrder() const;
         bool isNorm() const;
 
+        /**
+         * @brief Returns true if the scalar is a constant zero, which does not depend on any parameters.
+         * 
+         */
+        bool isZero() const;
+
         friend OptimizationProblem;
+        friend internal::WrapperBase;
         friend internal::SOCPWrapperBase;
         friend internal::QPWrapperBase;
 
@@ -146,8 +201,18 @@ namespace cvx
         friend Scalar sqrt(const Scalar &scalar);
         friend Scalar square(const Scalar &scalar);
         friend Scalar abs2(const Scalar &scalar);
-
-        // friend internal::Parameter::operator Scalar() const;
+        friend Scalar quad_form(const Eigen::Matrix<Scalar, Eigen::Dynamic, 1> &x,
+                                const Eigen::SparseMatrix<Scalar> &Q);
+        friend Scalar norm2(const Eigen::Matrix<Scalar, Eigen::Dynamic, 1> &x);
+        friend Eigen::Matrix<Scalar, Eigen::Dynamic, 1> colwiseNorm2(const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> &m);
+        friend Eigen::Matrix<Scalar, Eigen::Dynamic, 1> rowwiseNorm2(const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> &m);
+        friend Scalar norm1(const Eigen::Matrix<Scalar, Eigen::Dynamic, 1> &x);
+        friend Scalar normInf(const Eigen::Matrix<Scalar, Eigen::Dynamic, 1> &x);
+        friend Scalar max(const Eigen::Matrix<Scalar, Eigen::Dynamic, 1> &x);
+        friend Scalar abs(const Scalar &x);
+        friend Scalar pos(const Scalar &x);
+
+        friend internal::Parameter::operator Scalar() const;
         friend internal::Variable::operator Scalar() const;
 
         friend Constraint equalTo(const Scalar &lhs, const Scalar &rhs);
@@ -158,6 +223,8 @@ namespace cvx
     private:
         internal::Affine affine;
         std::vector<internal::Product> products;
+        std::vector<internal::QuadForm> quad_forms;
+        std::vector<internal::PiecewiseLinear> piecewise_linear;
         bool norm = false;
 
         friend std::ostream &operator<<(std::ostream &os, const Scalar &scalar);
@@ -311,4 +378,104 @@ namespace cvx
         return square(x);
     }
 
+    /**
+     * @brief Creates the 2-norm of a vector.
+     * 
+     * @details The squared elements are stored directly, which is cheaper than
+     * x.norm() for long vectors. Pass the result to lessThan() to create a cone.
+     * 
+     * @param x A vector of constant or linear terms
+     * @return Scalar The 2-norm of x
+     */
+    Scalar norm2(const VectorX &x);
+
+    /**
+     * @brief Creates the 2-norm of each column of a matrix.
+     * 
+     * @details This results in one cone per column when passed to lessThan(),
+     * e.g. one thrust cone per time step.
+     * 
+     * @param m A matrix of constant or linear terms
+     * @return VectorX A vector containing the 2-norm of each column
+     */
+    VectorX colwiseNorm2(const MatrixX &m);
+
+    /**
+     * @brief Creates the 2-norm of each row of a matrix.
+     * 
+     * @param m A matrix of constant or linear terms
+     * @return VectorX A vector containing the 2-norm of each row
+     */
+    VectorX rowwiseNorm2(const MatrixX &m);
+
+    /**
+     * @brief Creates the 1-norm of a vector.
+     * 
+     * @details Canonicalized with one slack variable and two rows per element.
+     * Can be used in cost functions and on the smaller side of inequalities.
+     * 
+     * @param x A vector of constant or linear terms
+     * @return Scalar The 1-norm of x
+     */
+    Scalar norm1(const VectorX &x);
+
+    /**
+     * @brief Creates the infinity norm of a vector.
+     * 
+     * @details Canonicalized with a single slack variable and two rows per element.
+     * 
+     * @param x A vector of constant or linear terms
+     * @return Scalar The largest absolute value in x
+     */
+    Scalar normInf(const VectorX &x);
+
+    /**
+     * @brief Creates the largest element of a vector.
+     * 
+     * @details Canonicalized with a single slack variable and one row per element.
+     * 
+     * @param x A vector of constant or linear terms
+     * @return Scalar The largest element of x
+     */
+    Scalar max(const VectorX &x);
+
+    /**
+     * @brief Creates the absolute value of a term. Use cwiseAbs() for Eigen types.
+     * 
+     * @param x A constant or linear term
+     * @return Scalar The absolute value of x
+     */
+    Scalar abs(const Scalar &x);
+
+    /**
+     * @brief Creates the positive part max(x, 0) of a term.
+     * 
+     * @param x A constant or linear term
+     * @return Scalar The positive part of x
+     */
+    Scalar pos(const Scalar &x);
+
+    /**
+     * @brief Creates the quadratic form x' * Q * x.
+     * 
+     * @details The matrix is stored directly instead of expanding the products,
+     * so the effort scales with the number of nonzeros in Q. Only the upper triangular
+     * part of Q is used, so Q has to be symmetric. Each element of x has to contain
+     * at most one variable.
+     * 
+     * @param x A vector of variables
+     * @param Q A sparse matrix of parameters, e.g. created with par() or dynpar()
+     * @return Scalar The quadratic form
+     */
+    Scalar quad_form(const VectorX &x, const Eigen::SparseMatrix<Scalar> &Q);
+
+    /**
+     * @brief Creates the quadratic form x' * Q * x.
+     * 
+     * @param x A vector of variables
+     * @param Q A dense matrix of parameters, e.g. created with par() or dynpar()
+     * @return Scalar The quadratic form
+     */
+    Scalar quad_form(const VectorX &x, const MatrixX &Q);
+
 } // namespace cvx
@@ -0,0 +1,60 @@
+/**
+ * @file horizon.hpp
+ *
+ */
+
+#pragma once
+
+#include "expressions.hpp"
+
+namespace cvx
+{
+    /**
+     * @brief A dynamic parameter matrix with one column per stage of a receding horizon.
+     *
+     * @details The columns are stored in a ring. shift() moves every stage one column towards
+     * the first stage by advancing the start of the ring, so no data is copied and the parameters
+     * that have been passed to the problem stay valid. After a shift the last stage holds the
+     * previous first stage and should be overwritten with setStage().
+     */
+    class HorizonParameter
+    {
+    public:
+        /**
+         * @brief Create the parameter with initial values.
+         *
+         * @param values The initial values with one column per stage
+         */
+        explicit HorizonParameter(const Eigen::MatrixXd &values);
+
+        size_t rows() const;
+        size_t stages() const;
+
+        /**
+         * @brief Move all stages one column towards the first stage.
+         *
+         */
+        void shift();
+
+        void setStage(size_t stage, const Eigen::VectorXd &values);
+        Eigen::VectorXd getStage(size_t stage) const;
+        Eigen::MatrixXd getValues() const;
+
+        friend MatrixX dynpar(const HorizonParameter &p);
+
+    private:
+        std::shared_ptr<internal::RingStorage> storage;
+    };
+
+    /**
+     * @brief Creates the dynamic parameters of a receding horizon parameter.
+     *
+     * @details The parameters refer to the stages and not to fixed memory locations,
+     * so they follow the data when the horizon is shifted.
+     *
+     * @param p The horizon parameter
+     * @return MatrixX The parameters with one column per stage
+     */
+    MatrixX dynpar(const HorizonParameter &p);
+
+} // namespace cvx
@@ -0,0 +1,69 @@
+/**
+ * @file operators.hpp
+ *
+ */
+
+#pragma once
+
+#include "expressions.hpp"
+
+namespace cvx
+{
+    /**
+     * @brief A sparse linear operator with parameters as coefficients.
+     *
+     * @details Multiplying an operator with a VectorX or MatrixX only touches the
+     * stored coefficients, so the effort scales with the number of nonzeros.
+     */
+    using LinearOperator = Eigen::SparseMatrix<Scalar>;
+
+    /**
+     * @brief Creates an identity operator.
+     *
+     * @param size The number of rows and columns
+     * @return LinearOperator The identity operator
+     */
+    LinearOperator identity(size_t size);
+
+    /**
+     * @brief Creates a diagonal operator.
+     *
+     * @param d The diagonal, e.g. created with par() or dynpar()
+     * @return LinearOperator The diagonal operator
+     */
+    LinearOperator diagonal(const VectorX &d);
+
+    /**
+     * @brief Creates a shift operator with ones on a single diagonal.
+     *
+     * @details The result of shift(size, k) * x is x shifted by k elements, so element i is x(i + k).
+     * Elements that are shifted in are zero. A negative offset shifts in the other direction.
+     *
+     * @param size The number of rows and columns
+     * @param offset The number of elements to shift by
+     * @return LinearOperator The shift operator
+     */
+    LinearOperator shift(size_t size, int offset);
+
+    /**
+     * @brief Creates the Kronecker product of two operators.
+     *
+     * @details Only the stored coefficients are multiplied, e.g. kron(identity(T), A)
+     * results in T blocks of A on the diagonal.
+     *
+     * @param lhs The outer operator
+     * @param rhs The inner operator
+     * @return LinearOperator The Kronecker product
+     */
+    LinearOperator kron(const LinearOperator &lhs, const LinearOperator &rhs);
+
+    /**
+     * @brief Creates the Kronecker product of an operator and a dense matrix.
+     *
+     * @param lhs The outer operator
+     * @param rhs A dense matrix of parameters, e.g. created with par() or dynpar()
+     * @return LinearOperator The Kronecker product
+     */
+    LinearOperator kron(const LinearOperator &lhs, const MatrixX &rhs);
+
+} // namespace cvx
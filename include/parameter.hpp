@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 namespace cvx
 {
@@ -15,6 +16,8 @@ namespace cvx
             Mul,
             Div,
             Sqrt,
+            Max,
+            Min,
         };
 
         enum class ParameterType
@@ -22,8 +25,12 @@ namespace cvx
             Constant,
             Pointer,
             Operation,
+            Sum,
+            Ring,
         };
 
+        class AffineParameterMap;
+
         class ParameterSource
         {
         public:
@@ -53,6 +60,8 @@ namespace cvx
 
         private:
             const double *ptr;
+
+            friend class AffineParameterMap;
         };
 
         class OperationSource final : public ParameterSource
@@ -69,6 +78,49 @@ namespace cvx
             ParamOpcode op;
             std::shared_ptr<ParameterSource> p1;
             std::shared_ptr<ParameterSource> p2;
+
+            friend class AffineParameterMap;
+        };
+
+        class SumSource final : public ParameterSource
+        {
+        public:
+            explicit SumSource(std::vector<std::shared_ptr<ParameterSource>> terms);
+            double getValue() const override;
+            ParameterType getType() const override;
+            bool operator==(const SumSource &other) const;
+
+        private:
+            std::vector<std::shared_ptr<ParameterSource>> terms;
+
+            friend class AffineParameterMap;
+        };
+
+        /**
+         * @brief Column major storage of a parameter matrix whose columns are used as a ring.
+         * 
+         * @details Column col of the parameters refers to column (head + col) % cols of the data.
+         */
+        struct RingStorage
+        {
+            std::vector<double> data;
+            size_t rows = 0;
+            size_t cols = 0;
+            size_t head = 0;
+        };
+
+        class RingSource final : public ParameterSource
+        {
+        public:
+            RingSource(std::shared_ptr<const RingStorage> storage, size_t row, size_t col);
+            double getValue() const override;
+            ParameterType getType() const override;
+            bool operator==(const RingSource &other) const;
+
+        private:
+            std::shared_ptr<const RingStorage> storage;
+            size_t row;
+            size_t col;
         };
 
         class Affine;
@@ -80,9 +132,11 @@ namespace cvx
             explicit Parameter(int const_value);
             explicit Parameter(double const_value);
             explicit Parameter(double *value_ptr);
+            Parameter(std::shared_ptr<const RingStorage> storage, size_t row, size_t col);
 
             bool isZero() const;
             bool isOne() const;
+            bool isConstant() const;
             double getValue() const;
 
             bool operator==(const Parameter &other) const;
@@ -102,12 +156,24 @@ namespace cvx
             explicit operator Scalar() const;
             explicit operator double() const;
 
+            friend Parameter sum(const std::vector<Parameter> &params);
             friend Parameter sqrt(const Parameter &param);
+            friend Parameter max(const Parameter &p1, const Parameter &p2);
+            friend Parameter min(const Parameter &p1, const Parameter &p2);
             friend std::ostream &operator<<(std::ostream &os, const Parameter &parameter);
+            friend class AffineParameterMap;
 
         private:
             std::shared_ptr<ParameterSource> source;
         };
 
+        /**
+         * @brief Sum up several parameters with a single operation.
+         * 
+         * @details Constants are combined, the remaining terms are evaluated in one pass
+         * instead of a chain of binary additions.
+         */
+        Parameter sum(const std::vector<Parameter> &params);
+
     } // namespace internal
 } // namespace cvx
\ No newline at end of file
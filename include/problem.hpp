@@ -45,19 +45,56 @@ namespace cvx
                             size_t rows,
                             size_t cols);
 
+        /**
+         * @brief Creates and returns a matrix of variables with a given sparsity pattern.
+         *
+         * @details Only the entries that are stored in the pattern are variables, all other entries are zero.
+         *
+         * @param name The name of the variable
+         * @param pattern A sparse matrix whose stored entries are the free entries of the variable
+         * @return MatrixX The matrix of variables
+         */
+        MatrixX addVariable(const std::string &name,
+                            const Eigen::SparseMatrix<double> &pattern);
+
+        /**
+         * @brief Creates and returns a symmetric matrix of variables.
+         *
+         * @details Only the upper triangular part is created. The entries below the diagonal
+         * refer to the same variables, so size * (size + 1) / 2 variables are passed to the solver.
+         *
+         * @param name The name of the variable
+         * @param size The number of rows and columns of the matrix
+         * @return MatrixX The symmetric matrix of variables
+         */
+        MatrixX addSymmetricVariable(const std::string &name,
+                                     size_t size);
+
+        /**
+         * @brief Creates and returns a diagonal matrix of variables. The off-diagonal entries are zero.
+         *
+         * @param name The name of the variable
+         * @param size The number of rows and columns of the matrix
+         * @return MatrixX The diagonal matrix of variables
+         */
+        MatrixX addDiagonalVariable(const std::string &name,
+                                    size_t size);
+
         /**
          * @brief Add a single constraint to the problem.
-         * found
+         * 
          * @param constraint The constraint created by equalTo(), lessThan(), greaterThan() or box()
+         * @return ConstraintHandle A handle to enable or disable the constraint
          */
-        void addConstraint(const Constraint &constraint);
+        ConstraintHandle addConstraint(const Constraint &constraint);
 
         /**
          * @brief Add multiple constraints to the problem.
          * 
          * @param constraint The constraint created by equalTo(), lessThan(), greaterThan() or box()
+         * @return ConstraintHandle A single handle to enable or disable all of the constraints
          */
-        void addConstraint(const std::vector<Constraint> &constraints);
+        ConstraintHandle addConstraint(const std::vector<Constraint> &constraints);
 
         /**
          * @brief Add a cost term to the problem's cost function. This has to be a scalar.
@@ -66,6 +103,33 @@ namespace cvx
          */
         void addCostTerm(const Scalar &term);
 
+        /**
+         * @brief Add a term to a named cost slot.
+         * 
+         * @details The cost function is the sum of the terms added with addCostTerm() and the weighted cost slots.
+         * All slots are canonicalized together, so switching between them only changes the values of the solver data.
+         * The first slot that is created is active, all other slots are inactive until they are activated.
+         * 
+         * @param slot The name of the cost slot. It is created if it does not exist yet.
+         * @param term A scalar cost term
+         */
+        void addCostSlotTerm(const std::string &slot, const Scalar &term);
+
+        /**
+         * @brief Activate a cost slot and deactivate all other slots.
+         * 
+         * @param slot The name of the cost slot
+         */
+        void activateCostSlot(const std::string &slot);
+
+        /**
+         * @brief Set the weight of a cost slot. Active slots have a weight of one, inactive slots a weight of zero.
+         * 
+         * @param slot The name of the cost slot
+         * @param weight The new weight
+         */
+        void setCostSlotWeight(const std::string &slot, double weight);
+
         /**
          * @brief Get the value of a scalar variable.
          * 
@@ -114,6 +178,19 @@ namespace cvx
          */
         void getVariable(const std::string &name, MatrixX &var);
 
+        /**
+         * @brief Get the slacks of the constraints of a handle. Only call this after the problem has been solved.
+         * 
+         * @details There is one value per constraint, grouped by type in the order equality, positive, box
+         * and cone constraints. The slack is the distance to the boundary of the constraint: the residual of
+         * an equality, the value of a positive constraint, the distance to the closer bound of a box and the
+         * difference between the right hand side and the norm of a cone. Active constraints have a slack of zero.
+         * 
+         * @param handle The constraint handle
+         * @param slacks The slacks, only resized if the number of constraints differs
+         */
+        void getSlackValue(const ConstraintHandle &handle, Eigen::VectorXd &slacks) const;
+
         /**
          * @brief Returns the evaluated cost function. Only call this after the problem has been solved.
          * 
@@ -133,16 +210,34 @@ namespace cvx
         friend std::ostream &operator<<(std::ostream &os, const OptimizationProblem &socp);
         friend internal::SOCPWrapperBase;
         friend internal::QPWrapperBase;
+        friend class ProblemBuilder;
 
     private:
         OptimizationProblem(const OptimizationProblem &other);
 
+        void addConstraint(const Constraint &constraint,
+                           const std::shared_ptr<internal::ConstraintSource> &source);
+
+        void checkMatrixVariableName(const std::string &name) const;
+
         Scalar costFunction;
 
+        struct CostSlot
+        {
+            Scalar cost;
+            // Referenced by the solver data as a dynamic parameter
+            double weight;
+        };
+        std::map<std::string, CostSlot> cost_slots;
+
+        // Incremented whenever the cost function changes
+        size_t cost_revision = 0;
+
         std::vector<internal::EqualityConstraint> equality_constraints;
         std::vector<internal::PositiveConstraint> positive_constraints;
         std::vector<internal::BoxConstraint> box_constraints;
         std::vector<internal::SecondOrderConeConstraint> second_order_cone_constraints;
+        std::vector<internal::RotatedSecondOrderConeConstraint> rotated_second_order_cone_constraints;
 
         std::map<std::string, Scalar> scalar_variables;
         std::map<std::string, VectorX> vector_variables;
@@ -0,0 +1,58 @@
+/**
+ * @file cancellation.hpp
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace cvx
+{
+
+    /**
+     * @brief A flag to cancel a solve that is running on another thread.
+     *
+     * @details Copies of a token share the same flag, so a token can be passed to a solve
+     * and cancelled by the caller afterwards. A token can not be reset after it has been cancelled.
+     */
+    class CancellationToken
+    {
+    public:
+        CancellationToken();
+
+        /**
+         * @brief A token that can never be cancelled. Solves with this token run without interruptions.
+         *
+         */
+        static CancellationToken none();
+
+        /**
+         * @brief Request the cancellation of all solves that use this token.
+         *
+         */
+        void cancel();
+
+        bool isCancelled() const;
+
+        /**
+         * @brief Returns false if the token has been created with none().
+         *
+         */
+        bool canBeCancelled() const;
+
+    private:
+        explicit CancellationToken(std::shared_ptr<std::atomic<bool>> cancelled);
+
+        std::shared_ptr<std::atomic<bool>> cancelled;
+    };
+
+    /**
+     * @brief Runs a job, e.g. by passing it to a thread pool.
+     *
+     */
+    using Executor = std::function<void(std::function<void()>)>;
+
+} // namespace cvx
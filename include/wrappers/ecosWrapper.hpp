@@ -11,8 +11,21 @@ namespace cvx::ecos
     {
 
     public:
-        explicit ECOSSolver(OptimizationProblem &problem);
+        /**
+         * @brief Create the solver for a problem.
+         * 
+         * @param problem The problem to solve
+         * @param presolve Remove fixed variables as well as empty and redundant rows before passing the problem to ECOS
+         */
+        explicit ECOSSolver(OptimizationProblem &problem, bool presolve = false);
         bool solve(bool verbose = false) override;
+
+        /**
+         * @brief Solve the problem unless the token has been cancelled.
+         * 
+         * @details ECOS can only be interrupted by a signal, so a solve that has already started runs to completion.
+         */
+        bool solve(const CancellationToken &token, bool verbose = false) override;
         std::string getResultString() const override;
         settings &getSettings();
         const stats &getInfo() const;
@@ -20,12 +33,23 @@ namespace cvx::ecos
         ~ECOSSolver();
 
     private:
+        void setup();
+
+        /**
+         * @brief Evaluate all entries of the problem data.
+         *
+         * @details ECOS equilibrates the data in place, so the constant entries are evaluated again as well.
+         */
         void update();
+
+        void swapUpdateBuffers() override;
+        void evaluatePreparedUpdate() override;
         void cleanUp();
+        void rebuildWorkspace() override;
 
         idxint exitflag = ECOS_UNSOLVED;
 
-        pwork *work;
+        pwork *work = nullptr;
 
         Eigen::Matrix<pfloat, Eigen::Dynamic, 1> G;
         Eigen::Matrix<pfloat, Eigen::Dynamic, 1> A;
@@ -33,6 +57,23 @@ namespace cvx::ecos
         Eigen::Matrix<pfloat, Eigen::Dynamic, 1> h;
         Eigen::Matrix<pfloat, Eigen::Dynamic, 1> b;
 
+        // The second buffer that is evaluated by prepareUpdate()
+        Eigen::Matrix<pfloat, Eigen::Dynamic, 1> G_prepared;
+        Eigen::Matrix<pfloat, Eigen::Dynamic, 1> A_prepared;
+        Eigen::Matrix<pfloat, Eigen::Dynamic, 1> c_prepared;
+        Eigen::Matrix<pfloat, Eigen::Dynamic, 1> h_prepared;
+        Eigen::Matrix<pfloat, Eigen::Dynamic, 1> b_prepared;
+
+        // The problem data as affine functions of the parameters
+        internal::AffineParameterMap G_map;
+        internal::AffineParameterMap A_map;
+        internal::AffineParameterMap c_map;
+        internal::AffineParameterMap h_map;
+        internal::AffineParameterMap b_map;
+
+        // The duals of the equality and the inequality constraints
+        Eigen::Matrix<pfloat, Eigen::Dynamic, 1> yz;
+
         Eigen::Matrix<idxint, Eigen::Dynamic, 1> cone_constraint_dimensions;
         Eigen::Matrix<idxint, Eigen::Dynamic, 1> G_row_ind;
         Eigen::Matrix<idxint, Eigen::Dynamic, 1> G_col_ind;
@@ -0,0 +1,114 @@
+/**
+ * @file osqpBatchSolver.hpp
+ *
+ */
+
+#pragma once
+
+#include "wrappers/osqpWrapper.hpp"
+
+namespace cvx::osqp
+{
+
+    /**
+     * @brief Solves many instances of a problem that only differ in the values of dynamic parameters.
+     *
+     * @details The problem is canonicalized once. Each worker thread gets its own OSQP workspace that is
+     * set up from the canonical data and warm started from the previous instance it has solved.
+     * The instances are handed out one at a time, so workers that finish early take over the remaining instances.
+     *
+     * The parameters are bound with dynpar() to memory that is owned by the user. Each worker evaluates
+     * the problem data with its own copy of the parameter maps that reads the values of the instance
+     * instead of this memory, so the evaluation runs in parallel and the user memory is not modified.
+     * Only parameters that have been created with dynpar() from a double can vary per instance. All other
+     * parameters, including the stages of a HorizonParameter, keep their current values in every instance.
+     */
+    class BatchSolver
+    {
+    public:
+        /**
+         * @brief Canonicalize the problem.
+         *
+         * @param problem The problem to solve
+         * @param parameters The memory of the dynamic parameters that change between instances, bound with dynpar()
+         * @param presolve Remove fixed variables as well as empty and redundant rows before passing the problem to OSQP
+         */
+        BatchSolver(OptimizationProblem &problem, const std::vector<double *> &parameters, bool presolve = false);
+
+        /**
+         * @brief The solver that holds the canonical problem. Its settings are used for all instances.
+         *
+         */
+        OSQPSolver &getSolver();
+
+        /**
+         * @brief Solve all instances.
+         *
+         * @param parameter_values One column per instance with one row per parameter
+         * @param num_threads The number of worker threads, by default the number of cores
+         */
+        void solve(const Eigen::MatrixXd &parameter_values, size_t num_threads = 0);
+
+        size_t getNumInstances() const;
+
+        /**
+         * @brief The solutions of the last batch.
+         *
+         * @return One row per instance and one column per variable of the problem, so the values
+         * of a variable are contiguous in memory
+         */
+        const Eigen::MatrixXd &getSolutions() const;
+
+        /**
+         * @brief The values of a single variable in all instances of the last batch.
+         *
+         */
+        Eigen::VectorXd getValues(const Scalar &variable) const;
+
+        /**
+         * @brief The OSQP status of each instance of the last batch.
+         *
+         */
+        const Eigen::Matrix<c_int, Eigen::Dynamic, 1> &getStatus() const;
+
+        /**
+         * @brief The number of iterations of each instance of the last batch.
+         *
+         */
+        const Eigen::Matrix<c_int, Eigen::Dynamic, 1> &getIterations() const;
+
+    private:
+        struct Worker
+        {
+            OSQPWorkspace *workspace = nullptr;
+            Eigen::Matrix<c_float, Eigen::Dynamic, 1> P_values;
+            Eigen::Matrix<c_float, Eigen::Dynamic, 1> A_values;
+            Eigen::Matrix<c_float, Eigen::Dynamic, 1> q;
+            Eigen::Matrix<c_float, Eigen::Dynamic, 1> l;
+            Eigen::Matrix<c_float, Eigen::Dynamic, 1> u;
+            OSQPSolver::MatrixUpdate P_update;
+            OSQPSolver::MatrixUpdate A_update;
+            std::vector<double> solution;
+
+            // The parameter values of the current instance and the maps that read them
+            std::vector<double> parameter_values;
+            internal::AffineParameterMap P_map;
+            internal::AffineParameterMap A_map;
+            internal::AffineParameterMap q_map;
+            internal::AffineParameterMap l_map;
+            internal::AffineParameterMap u_map;
+            internal::AffineParameterMap fixed_map;
+            Eigen::VectorXd fixed_values;
+        };
+
+        OSQPSolver solver;
+        std::vector<double *> parameters;
+
+        Eigen::MatrixXd solutions;
+        Eigen::Matrix<c_int, Eigen::Dynamic, 1> status;
+        Eigen::Matrix<c_int, Eigen::Dynamic, 1> iterations;
+
+        void solveInstance(Worker &worker, const Eigen::MatrixXd &parameter_values, size_t instance);
+    };
+
+} // namespace cvx::osqp
@@ -11,8 +11,23 @@ namespace cvx::osqp
     {
 
     public:
-        explicit OSQPSolver(OptimizationProblem &problem);
+        /**
+         * @brief Create the solver for a problem.
+         * 
+         * @param problem The problem to solve
+         * @param presolve Remove fixed variables as well as empty and redundant rows before passing the problem to OSQP
+         */
+        explicit OSQPSolver(OptimizationProblem &problem, bool presolve = false);
         bool solve(bool verbose = false) override;
+
+        /**
+         * @brief Solve the problem and stop early if the token is cancelled.
+         * 
+         * @details The iterations are run in chunks of the termination check interval that continue
+         * from the last iterate. The token is checked between the chunks. The time limit applies to the whole solve.
+         * A token that can not be cancelled runs a single uninterrupted solve.
+         */
+        bool solve(const CancellationToken &token, bool verbose = false) override;
         std::string getResultString() const override;
         const OSQPSettings &getSettings() const;
         const OSQPInfo &getInfo() const;
@@ -34,29 +49,146 @@ namespace cvx::osqp
         void setCheckTermination(c_int interval);
         void setWarmStart(bool warm_start);
 
+        /**
+         * @brief Warm start a variable of the problem.
+         * 
+         * @details The values are mapped to the solver variables and passed to OSQP. Variables that are not
+         * warm started explicitly keep the values of the last solution. The values are used by the next solve.
+         * 
+         * @param name The name of the variable
+         * @param value The initial value
+         */
+        void warmStart(const std::string &name, double value);
+        void warmStart(const std::string &name, const Eigen::VectorXd &values);
+        void warmStart(const std::string &name, const Eigen::MatrixXd &values);
+
+        /**
+         * @brief Warm start the duals of a constraint handle.
+         * 
+         * @details Rows that are not warm started explicitly keep the duals of the last solution.
+         * 
+         * @param handle The constraint handle
+         * @param duals One value per row of the handle, in the order the constraints have been added
+         */
+        void warmStart(const ConstraintHandle &handle, const Eigen::VectorXd &duals);
+
+        /**
+         * @brief Shift the warm start of a matrix variable by one stage of a receding horizon.
+         * 
+         * @details The columns of the variable are the stages. Each stage starts from the values of the
+         * next stage and the last stage keeps its values. The shifted values are passed to OSQP.
+         * 
+         * @param name The name of the matrix variable
+         */
+        void shiftWarmStart(const std::string &name);
+
+        /**
+         * @brief Shift the warm start duals of a constraint handle by one stage of a receding horizon.
+         * 
+         * @details The rows of the handle are interpreted as a matrix with one column per stage,
+         * in the order the constraints of a matrix have been created.
+         * 
+         * @param handle The constraint handle
+         * @param num_stages The number of stages
+         */
+        void shiftWarmStart(const ConstraintHandle &handle, size_t num_stages);
+
         void printSummary() const;
         ~OSQPSolver();
 
+        friend class BatchSolver;
+
     private:
-        Eigen::SparseMatrix<c_float> P;
-        Eigen::SparseMatrix<c_float> A;
+        // The nonzeros of P and A in compressed column order, updated in place
+        Eigen::Matrix<c_float, Eigen::Dynamic, 1> P_values;
+        Eigen::Matrix<c_float, Eigen::Dynamic, 1> A_values;
         Eigen::Matrix<c_float, Eigen::Dynamic, 1> q;
         Eigen::Matrix<c_float, Eigen::Dynamic, 1> l;
         Eigen::Matrix<c_float, Eigen::Dynamic, 1> u;
 
+        // The second buffer that is evaluated by prepareUpdate()
+        Eigen::Matrix<c_float, Eigen::Dynamic, 1> P_prepared;
+        Eigen::Matrix<c_float, Eigen::Dynamic, 1> A_prepared;
+        Eigen::Matrix<c_float, Eigen::Dynamic, 1> q_prepared;
+        Eigen::Matrix<c_float, Eigen::Dynamic, 1> l_prepared;
+        Eigen::Matrix<c_float, Eigen::Dynamic, 1> u_prepared;
+        bool prepared_rows_relaxed = false;
+
+        // The problem data as affine functions of the parameters
+        internal::AffineParameterMap P_map;
+        internal::AffineParameterMap A_map;
+        internal::AffineParameterMap q_map;
+        internal::AffineParameterMap l_map;
+        internal::AffineParameterMap u_map;
+
+        /**
+         * @brief Tracks the nonzeros of a matrix that depend on dynamic parameters.
+         *
+         * @details Changing P or A makes OSQP factorize the KKT system again, so only the
+         * dynamic nonzeros whose values have changed are passed to the workspace.
+         */
+        struct MatrixUpdate
+        {
+            Eigen::Matrix<c_int, Eigen::Dynamic, 1> dynamic_idx;
+            Eigen::Matrix<c_float, Eigen::Dynamic, 1> workspace_values;
+            Eigen::Matrix<c_int, Eigen::Dynamic, 1> changed_idx;
+            Eigen::Matrix<c_float, Eigen::Dynamic, 1> changed_values;
+        };
+        MatrixUpdate P_update;
+        MatrixUpdate A_update;
+
         c_int exitflag = OSQP_UNSOLVED;
 
+        // The bounds of disabled constraints have been overwritten in the last update
+        bool rows_relaxed = false;
+
         Eigen::Matrix<c_int, Eigen::Dynamic, 1> P_row_ind;
         Eigen::Matrix<c_int, Eigen::Dynamic, 1> P_col_ind;
         Eigen::Matrix<c_int, Eigen::Dynamic, 1> A_row_ind;
         Eigen::Matrix<c_int, Eigen::Dynamic, 1> A_col_ind;
 
-        OSQPWorkspace *workspace;
-        OSQPData data;
+        OSQPWorkspace *workspace = nullptr;
+        OSQPData data = {};
         OSQPSettings settings;
 
-        void update();
+        // The number of iterations between checks of the cancellation token if the termination is not checked
+        static constexpr c_int cancel_check_interval = 25;
+
+        void setup();
+
+        /**
+         * @brief Evaluate the problem data and pass the changed entries to the workspace.
+         *
+         */
+        void updateWorkspace();
+
+        /**
+         * @brief Evaluate the problem data.
+         *
+         * @param all_entries Also evaluate the constant entries, otherwise only the dynamic entries are updated
+         */
+        void update(bool all_entries = false);
+
+        void swapUpdateBuffers() override;
+        void evaluatePreparedUpdate() override;
+
+        /**
+         * @brief Initialize the update tracking of a matrix after the workspace has been set up.
+         *
+         */
+        static void setupMatrixUpdate(const internal::AffineParameterMap &map,
+                                      const Eigen::Matrix<c_float, Eigen::Dynamic, 1> &values,
+                                      MatrixUpdate &matrix_update);
+
+        /**
+         * @brief Collect the dynamic nonzeros that differ from the values in the workspace.
+         *
+         * @return c_int The number of changed nonzeros, stored at the front of changed_idx and changed_values
+         */
+        static c_int collectChanges(const Eigen::Matrix<c_float, Eigen::Dynamic, 1> &values,
+                                    MatrixUpdate &matrix_update);
         void cleanUp();
+        void rebuildWorkspace() override;
     };
 
 } // namespace cvx::osqp
\ No newline at end of file
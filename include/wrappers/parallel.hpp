@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace cvx::internal
+{
+
+    /**
+     * @brief The settings of parallelFor(). They must not be changed while a solver is created.
+     *
+     */
+    struct ParallelSettings
+    {
+        // The maximum number of threads, 0 for the number of cores
+        size_t max_threads = 0;
+        // The minimum number of indices per thread
+        size_t min_chunk = 1024;
+    };
+
+    inline ParallelSettings parallel_settings;
+
+    /**
+     * @brief Call f(i) for every index in [begin, end) on multiple threads.
+     *
+     * @details The range is split into one contiguous chunk per thread. Ranges with fewer than
+     * min_chunk indices per thread are processed on the calling thread. f may only modify data
+     * that belongs to its index, so the result does not depend on the number of threads.
+     * The first exception of a chunk is rethrown after all threads have finished.
+     */
+    template <typename F>
+    void parallelFor(size_t begin, size_t end, F &&f, size_t min_chunk = parallel_settings.min_chunk)
+    {
+        const size_t size = end > begin ? end - begin : 0;
+        const size_t max_threads = parallel_settings.max_threads > 0
+                                       ? parallel_settings.max_threads
+                                       : std::max(std::thread::hardware_concurrency(), 1u);
+        min_chunk = std::max(min_chunk, size_t(1));
+        const size_t num_threads = std::min(max_threads, std::max(size / min_chunk, size_t(1)));
+
+        if (num_threads == 1)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                f(i);
+            }
+            return;
+        }
+
+        std::vector<std::exception_ptr> errors(num_threads);
+        auto run_chunk = [&](size_t chunk) {
+            try
+            {
+                const size_t chunk_begin = begin + size * chunk / num_threads;
+                const size_t chunk_end = begin + size * (chunk + 1) / num_threads;
+                for (size_t i = chunk_begin; i < chunk_end; i++)
+                {
+                    f(i);
+                }
+            }
+            catch (...)
+            {
+                errors[chunk] = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(num_threads - 1);
+        for (size_t chunk = 1; chunk < num_threads; chunk++)
+        {
+            threads.emplace_back(run_chunk, chunk);
+        }
+        run_chunk(0);
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+
+        for (const std::exception_ptr &error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+} // namespace cvx::internal
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "expressions.hpp"
+
+#include <unordered_map>
+
+namespace cvx::internal
+{
+
+    /**
+     * @brief Evaluates a vector of parameters as an affine function of the dynamic parameters.
+     *
+     * @details Each entry that is an affine combination of dynamic parameters is stored as a row of a
+     * sparse matrix M and an offset b, so all of them are evaluated with values = M * p + b where p
+     * holds the current parameter values. Entries that are not affine, e.g. products of two dynamic
+     * parameters, divisions by a dynamic parameter or square roots, are evaluated with their expression tree.
+     *
+     * Only the dynamic entries are stored in M. They are grouped into runs of consecutive entries,
+     * so an update copies a few contiguous segments and does not touch the constant entries.
+     */
+    class AffineParameterMap
+    {
+    public:
+        AffineParameterMap() = default;
+
+        /**
+         * @brief Compile the parameters into an affine map.
+         *
+         * @param params The parameters to evaluate
+         * @param scale A factor that is applied to all entries, e.g. -1 for solvers that expect negated data
+         */
+        explicit AffineParameterMap(const std::vector<Parameter> &params, double scale = 1.);
+        explicit AffineParameterMap(const Eigen::Matrix<Parameter, Eigen::Dynamic, 1> &params, double scale = 1.);
+
+        /**
+         * @brief The number of evaluated entries.
+         *
+         */
+        size_t size() const;
+
+        /**
+         * @brief The number of distinct dynamic parameters in the affine entries.
+         *
+         */
+        size_t getNumParameters() const;
+
+        /**
+         * @brief The number of entries that are evaluated with their expression tree.
+         *
+         */
+        size_t getNumNonaffine() const;
+
+        /**
+         * @brief The sorted indices of the entries that depend on dynamic parameters.
+         *
+         * @details All other entries are constant and keep their value.
+         */
+        std::vector<size_t> getDynamicIndices() const;
+
+        /**
+         * @brief Evaluate all entries with the current parameter values.
+         *
+         */
+        Eigen::VectorXd evaluate() const;
+
+        /**
+         * @brief Evaluate all entries in place without allocating memory.
+         *
+         * @param values The output with size() entries
+         */
+        void evaluate(Eigen::Ref<Eigen::VectorXd> values) const;
+
+        /**
+         * @brief Evaluate only the entries that depend on dynamic parameters.
+         *
+         * @param values The output with size() entries. The constant entries must still hold the values from evaluate().
+         */
+        void updateDynamic(Eigen::Ref<Eigen::VectorXd> values) const;
+
+        /**
+         * @brief Copy the map and read some of the pointer parameters from other memory.
+         *
+         * @details Entries that have been bound to pointers[i] with dynpar() read values[i] in the copy.
+         * Each copy has its own evaluation buffers, so copies can be evaluated on different threads.
+         * Ring sources are not replaced and still read the storage of the original map.
+         *
+         * @param pointers The memory the parameters have been bound to
+         * @param values The memory to read instead, with the same size as pointers
+         */
+        AffineParameterMap rebind(const std::vector<double *> &pointers, const std::vector<const double *> &values) const;
+
+    private:
+        struct AffineTerms
+        {
+            double offset = 0.;
+            std::vector<std::pair<std::shared_ptr<ParameterSource>, double>> coefficients;
+        };
+
+        // A range of consecutive dynamic entries
+        struct Run
+        {
+            size_t start;
+            size_t size;
+        };
+
+        // The pointer and ring sources the affine entries depend on
+        std::vector<std::shared_ptr<ParameterSource>> parameters;
+
+        // The values of the constant entries, zero for the dynamic entries
+        Eigen::VectorXd static_values;
+
+        // The dynamic entries in the order of the runs
+        std::vector<Run> dynamic_runs;
+        Eigen::SparseMatrix<double, Eigen::RowMajor> coefficients;
+        Eigen::VectorXd offset;
+        std::vector<size_t> nonaffine_positions;
+        std::vector<Parameter> nonaffine_params;
+        double nonaffine_scale = 1.;
+
+        // Hold the gathered parameter values and the dynamic entries during evaluation
+        mutable Eigen::VectorXd parameter_values;
+        mutable Eigen::VectorXd dynamic_values;
+
+        void build(const Parameter *params, size_t size, double scale);
+
+        /**
+         * @brief Add scale times a parameter source to terms.
+         *
+         * @return false if the source is not affine in the pointer and ring sources
+         */
+        static bool addTerms(const std::shared_ptr<ParameterSource> &source, double scale, AffineTerms &terms);
+
+        /**
+         * @brief Replace the pointer sources in an expression tree.
+         *
+         * @return The source itself if it does not depend on any of the replaced pointers
+         */
+        static std::shared_ptr<ParameterSource> rebindSource(const std::shared_ptr<ParameterSource> &source,
+                                                             const std::unordered_map<const double *, const double *> &pointers);
+    };
+
+} // namespace cvx::internal
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "expressions.hpp"
+
+namespace cvx::internal
+{
+
+    /**
+     * @brief A nonzero of a canonical matrix. The coefficient is an index into the coefficient table.
+     *
+     */
+    struct CoefficientTriplet
+    {
+        int row;
+        int col;
+        int coefficient;
+    };
+
+    /**
+     * @brief Collects the nonzeros of a matrix during canonicalization.
+     *
+     * @details The positions are stored as plain integers and the coefficients in a separate table,
+     * so building the sparsity pattern only has to sort integers.
+     */
+    class CoefficientList
+    {
+    public:
+        void reserve(size_t size);
+        void add(size_t row, size_t col, const Parameter &coefficient);
+
+        /**
+         * @brief Move all coefficients of another list to the end of this list.
+         * 
+         * @param other The list to move from, it is empty afterwards
+         * @param row_offset Added to the row of each moved coefficient
+         */
+        void append(CoefficientList &other, size_t row_offset = 0);
+        size_t size() const;
+        bool empty() const;
+
+        std::vector<CoefficientTriplet> triplets;
+        std::vector<Parameter> coefficients;
+    };
+
+    /**
+     * @brief A sparse matrix of parameters in compressed column storage.
+     *
+     */
+    class ParameterMatrix
+    {
+    public:
+        ParameterMatrix() = default;
+        ParameterMatrix(size_t rows, size_t cols);
+
+        size_t rows() const;
+        size_t cols() const;
+        size_t nonZeros() const;
+
+        /**
+         * @brief Build the matrix from a list of coefficients.
+         *
+         * @details The pattern is built with a counting sort over the columns and a sort of the
+         * row indices within each column. Duplicate entries are merged into a single sum.
+         * The coefficients are moved out of the list.
+         *
+         * @param list The coefficients with positions inside the current size of the matrix
+         */
+        void setFromCoefficients(CoefficientList &list);
+
+        void resize(size_t rows, size_t cols);
+
+        /**
+         * @brief Change the size while keeping the nonzeros. Rows and columns can only be appended.
+         *
+         */
+        void conservativeResize(size_t rows, size_t cols);
+
+        /**
+         * @brief Append all nonzeros to a coefficient list.
+         *
+         * @param list The list to append to
+         * @param row_offset Added to the row of each nonzero
+         */
+        void appendTo(CoefficientList &list, size_t row_offset = 0) const;
+
+        const int *outerIndexPtr() const;
+        const int *innerIndexPtr() const;
+        const std::vector<Parameter> &values() const;
+
+        /**
+         * @brief Evaluate the nonzeros in compressed column order.
+         *
+         */
+        Eigen::VectorXd evalValues() const;
+
+    private:
+        size_t num_rows = 0;
+        size_t num_cols = 0;
+        std::vector<int> outer_index = {0};
+        std::vector<int> inner_index;
+        std::vector<Parameter> value_params;
+    };
+
+} // namespace cvx::internal
+
+namespace cvx
+{
+
+    /**
+     * @brief Evaluate a parameter matrix.
+     *
+     * @param m The matrix to evaluate
+     * @return Eigen::SparseMatrix<double> The evaluated matrix with the same pattern
+     */
+    Eigen::SparseMatrix<double> eval(const internal::ParameterMatrix &m);
+
+} // namespace cvx
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "wrappers/parameterMatrix.hpp"
+
+namespace cvx::internal
+{
+
+    /**
+     * @brief Removes fixed variables, empty rows and redundant rows from the canonical problem data.
+     *
+     * @details The rows are given in the form lower <= a'x <= upper. All decisions are made
+     * on the sparsity pattern and on constant coefficients only, so dynamic parameters may
+     * change between solves. Bounds that depend on them are kept as parameter expressions.
+     *
+     * The following reductions are made:
+     * - A variable with exactly one singleton equality row is fixed and substituted.
+     * - Rows without any remaining variables are removed if their constant bounds hold.
+     *   Otherwise they are kept as rows without coefficients.
+     * - Singleton rows are scaled to a unit coefficient.
+     * - Rows with identical coefficients are merged into one row with the tightest bounds.
+     */
+    class Presolve
+    {
+    public:
+        using VectorXp = Eigen::Matrix<Parameter, Eigen::Dynamic, 1>;
+
+        enum class RowType
+        {
+            Range,      // lower <= a'x <= upper
+            Equality,   // a'x == lower
+            Inequality, // a'x >= lower
+            Cone,       // Part of a cone, only a'x - lower is preserved
+        };
+
+        /**
+         * @brief Analyze the problem and build the reduced problem data.
+         *
+         * @param A The constraint matrix
+         * @param lower The lower bounds of the rows
+         * @param upper The upper bounds of the rows, only used for range rows
+         * @param row_types The type of each row
+         * @param P The upper triangular part of the quadratic cost
+         * @param q The linear cost
+         */
+        Presolve(const ParameterMatrix &A,
+                 const VectorXp &lower,
+                 const VectorXp &upper,
+                 const std::vector<RowType> &row_types,
+                 const ParameterMatrix &P,
+                 const VectorXp &q);
+
+        size_t getNumReducedRows() const;
+        size_t getNumReducedColumns() const;
+        size_t getNumReducedRows(RowType type) const;
+
+        ParameterMatrix getReducedMatrix(size_t first_row, size_t num_rows) const;
+        VectorXp getReducedLower(size_t first_row, size_t num_rows) const;
+        VectorXp getReducedUpper(size_t first_row, size_t num_rows) const;
+        ParameterMatrix getReducedQuadraticCost() const;
+        VectorXp getReducedLinearCost() const;
+
+        enum class RowStatus
+        {
+            Kept,    // The row is passed to the solver
+            Merged,  // The row has been merged with other rows
+            Fixing,  // The row fixes a variable
+            Removed, // The row does not contain any variables
+        };
+
+        RowStatus getRowStatus(size_t row) const;
+        size_t getReducedRow(size_t row) const;
+
+        /**
+         * @brief Map a solution of the reduced problem back to all variables.
+         *
+         * @param x_reduced The solution of the reduced problem
+         * @param x The full solution
+         */
+        void postsolvePrimal(const double *x_reduced, std::vector<double> &x) const;
+
+        /**
+         * @brief Map a solution of the reduced problem back to all variables with given values of the fixed variables.
+         *
+         * @param x_reduced The solution of the reduced problem
+         * @param fixed_values The evaluated values of getFixedValues()
+         * @param x The full solution
+         */
+        void postsolvePrimal(const double *x_reduced, const Eigen::VectorXd &fixed_values, std::vector<double> &x) const;
+
+        /**
+         * @brief The values of the fixed variables, which may depend on the parameters.
+         *
+         */
+        std::vector<Parameter> getFixedValues() const;
+
+        /**
+         * @brief Map the dual solution of the reduced problem back to all rows.
+         *
+         * @details The duals of fixing rows are recovered from stationarity,
+         * g(x) + sign * A'y = 0, so the full primal solution must be available.
+         *
+         * @param x The full primal solution
+         * @param y_reduced The dual solution of the reduced problem
+         * @param sign The sign of the constraint matrix in the solver's stationarity condition
+         * @param y The full dual solution
+         */
+        void postsolveDual(const std::vector<double> &x,
+                           const double *y_reduced,
+                           double sign,
+                           Eigen::VectorXd &y) const;
+
+        /**
+         * @brief Restrict a full solution to the variables of the reduced problem.
+         *
+         */
+        Eigen::VectorXd reducePrimal(const std::vector<double> &x) const;
+
+        /**
+         * @brief Map a full dual solution to the rows of the reduced problem.
+         *
+         * @details The duals of merged rows are added up and the duals of fixing rows are dropped.
+         * This reverses postsolveDual() for the rows that are passed to the solver.
+         */
+        Eigen::VectorXd reduceDual(const Eigen::VectorXd &y) const;
+
+    private:
+        struct Member
+        {
+            size_t row;
+            double scale;
+            Parameter lower;
+            Parameter upper;
+        };
+
+        struct ReducedRow
+        {
+            RowType type;
+            std::vector<std::pair<size_t, Parameter>> coefficients;
+            std::vector<Member> members;
+            Parameter lower;
+            Parameter upper;
+        };
+
+        struct FixedColumn
+        {
+            size_t column;
+            size_t row;
+            double coefficient;
+            Parameter value;
+            std::vector<std::pair<size_t, Parameter>> column_entries;
+            std::vector<std::pair<size_t, Parameter>> quadratic_entries;
+            Parameter linear;
+        };
+
+        size_t num_rows;
+        std::vector<int> column_map;
+        std::vector<RowStatus> row_status;
+        std::vector<size_t> row_map;
+        std::vector<ReducedRow> reduced_rows;
+        std::vector<FixedColumn> fixed_columns;
+        CoefficientList P_reduced_coeffs;
+        VectorXp q_reduced;
+    };
+
+} // namespace cvx
@@ -9,7 +9,13 @@ namespace cvx::internal
     {
 
     public:
-        explicit QPWrapperBase(OptimizationProblem &problem);
+        /**
+         * @brief Canonicalize the problem.
+         * 
+         * @param problem The problem to canonicalize
+         * @param presolve Remove fixed variables as well as empty and redundant rows before passing the problem to the solver
+         */
+        QPWrapperBase(OptimizationProblem &problem, bool presolve);
 
         bool isConvex() const;
 
@@ -17,17 +23,80 @@ namespace cvx::internal
 
         size_t getNumInequalityConstraints() const;
 
+        /**
+         * @brief Add the constraints that have been added to the problem after creating the solver.
+         * 
+         * @details Only the new constraints are canonicalized and appended to the existing problem data.
+         * Variables that appear for the first time are appended as well. The solver workspace is rebuilt afterwards.
+         * The problem must still exist and its cost function must not have changed.
+         * This is not possible if the problem has been presolved.
+         */
+        void addNewConstraints();
+
         friend std::ostream &operator<<(std::ostream &os, const QPWrapperBase &wrapper);
 
     protected:
-        Eigen::SparseMatrix<Parameter> A_params;
-        Eigen::SparseMatrix<Parameter> P_params;
+        OptimizationProblem &problem;
+        ParameterMatrix A_params;
+        ParameterMatrix P_params;
         VectorXp q_params;
         VectorXp l_params;
         VectorXp u_params;
+        std::vector<RowBlock> constraint_rows;
+
+        /**
+         * @brief Replace the bounds of disabled constraints with infinite values.
+         * 
+         * @param l The evaluated lower bounds
+         * @param u The evaluated upper bounds
+         * @return true if any row has been relaxed
+         */
+        bool relaxDisabledRows(Eigen::Ref<Eigen::VectorXd> l, Eigen::Ref<Eigen::VectorXd> u) const;
 
     private:
+        // The number of constraints and cost terms that have already been canonicalized
+        size_t num_equality_constraints = 0;
+        size_t num_positive_constraints = 0;
+        size_t num_box_constraints = 0;
+        size_t cost_revision = 0;
+        size_t num_lifted = 0;
+
+        // Squares of affine expressions with at least this many variables are lifted
+        static constexpr size_t min_lifted_terms = 3;
+
+        bool canonicalizeNewConstraints();
+        void appendRows(CoefficientList &A_coeffs,
+                        std::vector<Parameter> &l_coeffs,
+                        std::vector<Parameter> &u_coeffs);
+
+        /**
+         * @brief Add a cost term scaled with weight.
+         * 
+         * @details The linear coefficients are appended to q_coeffs and summed up once all variables are known.
+         * Rows for lifted squares and slack variables are appended to A_coeffs, l_coeffs and u_coeffs.
+         */
+        void addCost(Scalar &cost,
+                     const Parameter &weight,
+                     CoefficientList &q_coeffs,
+                     CoefficientList &P_coeffs,
+                     CoefficientList &A_coeffs,
+                     std::vector<Parameter> &l_coeffs,
+                     std::vector<Parameter> &u_coeffs);
+
+        /**
+         * @brief Replace the square of an affine expression with the square of an auxiliary variable.
+         * 
+         * @details The auxiliary variable y is constrained by y == a'x + b. This keeps P diagonal
+         * and only adds the nonzeros of a to A instead of a dense block to P.
+         */
+        void liftSquare(Affine &affine,
+                        const Parameter &weight,
+                        CoefficientList &P_coeffs,
+                        CoefficientList &A_coeffs,
+                        std::vector<Parameter> &l_coeffs,
+                        std::vector<Parameter> &u_coeffs);
         void addVariable(Variable &variable) final override;
+        void presolveProblem();
     };
 
 } // namespace cvx
\ No newline at end of file
@@ -9,27 +9,91 @@ namespace cvx::internal
     {
 
     public:
-        explicit SOCPWrapperBase(OptimizationProblem &problem);
+        /**
+         * @brief Canonicalize the problem.
+         * 
+         * @param problem The problem to canonicalize
+         * @param presolve Remove fixed variables as well as empty and redundant rows before passing the problem to the solver
+         */
+        SOCPWrapperBase(OptimizationProblem &problem, bool presolve);
 
         size_t getNumEqualityConstraints() const;
         size_t getNumInequalityConstraints() const;
         size_t getNumPositiveConstraints() const;
         size_t getNumCones() const;
 
+        /**
+         * @brief Add the constraints that have been added to the problem after creating the solver.
+         * 
+         * @details Only the new constraints are canonicalized and appended to the existing problem data.
+         * Variables that appear for the first time are appended as well. The solver workspace is rebuilt afterwards.
+         * The problem must still exist and its cost function must not have changed.
+         * This is not possible if the problem has been presolved.
+         */
+        void addNewConstraints();
+
         bool isFeasible(double tolerance) const final override;
 
         friend std::ostream &operator<<(std::ostream &os, const SOCPWrapperBase &wrapper);
 
     protected:
-        Eigen::SparseMatrix<Parameter> A_params;
-        Eigen::SparseMatrix<Parameter> G_params;
+        ParameterMatrix A_params;
+        ParameterMatrix G_params;
         VectorXp c_params;
         VectorXp h_params;
         VectorXp b_params;
         Eigen::VectorXi soc_dims;
+        std::vector<RowBlock> equality_rows;
+        std::vector<RowBlock> inequality_rows;
+
+        /**
+         * @brief Reduce the rows of disabled constraints to 0 <= 1, ||0|| <= 1 for cones and 0 == 0 for equalities.
+         * 
+         * @details The sparsity pattern is not changed, the values of the relaxed rows are overwritten.
+         * A relaxed equality is a zero row of A, so A does not have full row rank anymore. ECOS relies on the
+         * regularization of its KKT system in this case.
+         * 
+         * @param G_values The evaluated nonzeros of G in compressed column order
+         * @param h The evaluated vector h
+         * @param A_values The evaluated nonzeros of A in compressed column order
+         * @param b The evaluated vector b
+         * @return true if any row has been relaxed
+         */
+        bool relaxDisabledRows(Eigen::Ref<Eigen::VectorXd> G_values, Eigen::Ref<Eigen::VectorXd> h,
+                               Eigen::Ref<Eigen::VectorXd> A_values, Eigen::Ref<Eigen::VectorXd> b) const;
 
     private:
+        OptimizationProblem &problem;
+
+        // The number of constraints and cost terms that have already been canonicalized
+        size_t num_equality_constraints = 0;
+        size_t num_positive_constraints = 0;
+        size_t num_box_constraints = 0;
+        size_t num_cone_constraints = 0;
+        size_t num_rotated_cone_constraints = 0;
+        size_t cost_revision = 0;
+
+        // Epigraphs of quadratic cost terms and slack rows that have not been canonicalized yet
+        std::vector<RotatedSecondOrderConeConstraint> cost_cones;
+        std::vector<PositiveConstraint> cost_rows;
+
+        bool canonicalizeNewConstraints();
+
+        /**
+         * @brief Add a cost term scaled with weight.
+         * 
+         * @details Quadratic terms are moved to the constraints with an epigraph variable t
+         * and the rotated cone ||z||^2 <= t. Squares are used directly, other products and
+         * quadratic forms are factorized and must have constant coefficients. Piecewise linear
+         * terms are replaced with slack variables.
+         * 
+         * @param cost The cost term
+         * @param weight The weight of the cost term
+         * @param c_coeffs The linear coefficients, summed up once all variables are known
+         */
+        void addCost(Scalar &cost, const Parameter &weight, CoefficientList &c_coeffs);
         void addVariable(Variable &variable) final override;
+        void presolveProblem();
     };
 
 } // namespace cvx
\ No newline at end of file
@@ -1,10 +1,30 @@
 #pragma once
 
 #include "problem.hpp"
+#include "wrappers/presolve.hpp"
+#include "wrappers/parameterMap.hpp"
+#include "wrappers/cancellation.hpp"
+
+#include <future>
+#include <mutex>
 
 namespace cvx::internal
 {
 
+    /**
+     * @brief A contiguous range of solver rows that belong to the same constraint handle.
+     * 
+     */
+    struct RowBlock
+    {
+        std::shared_ptr<ConstraintSource> source;
+        size_t start;
+        size_t size;
+        // The type of the constraints and the number of rows that each of them has created
+        Constraint::Type type;
+        size_t constraint_rows;
+    };
+
     class WrapperBase
     {
 
@@ -12,21 +32,290 @@ namespace cvx::internal
         WrapperBase() = default;
         virtual ~WrapperBase();
         virtual bool solve(bool verbose = false) = 0;
+
+        /**
+         * @brief Solve the problem and stop early if the token is cancelled.
+         * 
+         * @return false if the solve has been cancelled or failed
+         */
+        virtual bool solve(const CancellationToken &token, bool verbose = false) = 0;
+
+        /**
+         * @brief Solve the problem on another thread.
+         * 
+         * @details The solver and the problem must not be used until the future is ready.
+         * A cancelled solve returns false and keeps the last iterate as the solution.
+         * 
+         * @param token The token to cancel the solve, by default the solve can not be cancelled
+         * @param executor Runs the solve, by default on a new detached thread
+         * @return std::future<bool> The result of the solve, or the exception it has thrown
+         */
+        std::future<bool> solveAsync(const CancellationToken &token = CancellationToken::none(),
+                                     const Executor &executor = Executor());
+
+        /**
+         * @brief Returns true if the last solve has been cancelled.
+         * 
+         */
+        bool wasCancelled() const;
+
+        /**
+         * @brief Evaluate the problem data for the next solve into a second buffer.
+         * 
+         * @details The parameters are read with their current values and the current enabled constraints.
+         * The next solve swaps the buffers instead of evaluating the parameters, so the parameters may be
+         * changed as soon as this returns. This may run on another thread while a solve is in progress,
+         * which hides the evaluation behind the solve. Data that has not been used by a solve yet is replaced.
+         * solveAsync() takes the prepared data when it is called, so the data for the following solve
+         * can be prepared right away.
+         * 
+         */
+        void prepareUpdate();
+
+        /**
+         * @brief Run prepareUpdate() on another thread.
+         * 
+         * @param executor Runs the evaluation, by default on a new detached thread
+         * @return std::future<void> Ready when the data has been prepared, or the exception that has been thrown
+         */
+        std::future<void> prepareUpdateAsync(const Executor &executor = Executor());
+
         virtual std::string getResultString() const = 0;
         size_t getNumVariables() const;
         virtual bool isFeasible(double tolerance) const = 0;
 
+        /**
+         * @brief Get the duals of the constraints of a handle from the last solve.
+         * 
+         * @details There is one value per solver row of the handle, in the order the rows have been created.
+         * The sign follows the convention of the solver. Constraints that are canonicalized to several rows,
+         * e.g. boxes with variable bounds or cones, have one dual per row.
+         * 
+         * @param handle The constraint handle
+         * @param duals The duals, only resized if the number of rows differs
+         */
+        void getDualValue(const ConstraintHandle &handle, Eigen::VectorXd &duals) const;
+
     protected:
         using MatrixXp = Eigen::Matrix<Parameter, Eigen::Dynamic, Eigen::Dynamic>;
         using VectorXp = Eigen::Matrix<Parameter, Eigen::Dynamic, 1>;
         std::vector<Variable> variables;
         std::shared_ptr<std::vector<double>> solution = std::make_shared<std::vector<double>>();
+        Eigen::VectorXd dual_solution;
+
+        // Only set if the problem has been presolved
+        std::unique_ptr<Presolve> presolve;
+        std::vector<RowBlock> presolved_rows;
+
+        // The rows of each constraint in the order of dual_solution, before the presolve
+        std::vector<RowBlock> dual_rows;
+        size_t num_dual_rows = 0;
+
+        // Set if the last solve has been cancelled
+        bool cancelled = false;
+
+        // Guards the problem data against prepareUpdate() on another thread
+        std::mutex update_mutex;
+        bool update_prepared = false;
+        // Set if solveAsync() has already swapped the prepared data into the current buffer
+        bool update_claimed = false;
+
+        /**
+         * @brief Evaluate the problem data into the second buffer. Called with update_mutex locked.
+         * 
+         */
+        virtual void evaluatePreparedUpdate() = 0;
+
+        /**
+         * @brief Swap the problem data with the second buffer. Called with update_mutex locked.
+         * 
+         */
+        virtual void swapUpdateBuffers() = 0;
+
+        /**
+         * @brief Swap the prepared data into the current buffer if there is any. Called with update_mutex locked.
+         * 
+         * @return false if no data has been prepared and the parameters have to be evaluated
+         */
+        bool takePreparedUpdate();
+
+        /**
+         * @brief Discard the prepared data after the workspace has been set up again. Called with update_mutex locked.
+         * 
+         */
+        void discardPreparedUpdate();
+
+        // Warm start values for all variables and rows, cleared by the next solve
+        std::vector<double> primal_guess;
+        Eigen::VectorXd dual_guess;
+
+        /**
+         * @brief The number of variables that are passed to the solver.
+         * 
+         */
+        size_t getNumSolverVariables() const;
+
+        /**
+         * @brief Map row blocks to the rows of the presolved problem.
+         * 
+         * @details Rows that have been merged or that fix a variable are moved to presolved_rows.
+         * 
+         * @param blocks The row blocks to map
+         * @param row_offset The index of the first row of the blocks in the presolve rows
+         * @param reduced_offset The index of the first row of the blocks in the reduced presolve rows
+         */
+        void reduceRowBlocks(std::vector<RowBlock> &blocks, size_t row_offset, size_t reduced_offset);
+
+        /**
+         * @brief Throw if a constraint that has been changed by the presolve is disabled.
+         * 
+         */
+        void checkPresolvedRows() const;
+
+        /**
+         * @brief Store the primal solution from the solver, undoing the presolve if necessary.
+         * 
+         * @param x The solution of the solver
+         */
+        void setSolution(const double *x);
+
+        /**
+         * @brief Store the dual solution from the solver, undoing the presolve if necessary.
+         * 
+         * @param y The dual solution of the solver
+         * @param sign The sign of the constraint matrix in the stationarity condition of the solver
+         */
+        void setDualSolution(const Eigen::Ref<const Eigen::VectorXd> &y, double sign);
+
+        /**
+         * @brief Set the warm start values of a block of variables.
+         * 
+         * @details Entries that are not a single variable of this solver are skipped.
+         * All other variables keep their values from the last solution.
+         * 
+         * @param block The variables
+         * @param values The values with the same size as the block
+         */
+        void setPrimalGuess(const MatrixX &block, const Eigen::MatrixXd &values);
+
+        /**
+         * @brief Set the warm start values of the duals of a constraint handle.
+         * 
+         * @details The values are given for the rows of the handle in the order they have been added.
+         * All other rows keep their values from the last solution.
+         * 
+         * @param handle The constraint handle
+         * @param values One value per row of the handle
+         */
+        void setDualGuess(const ConstraintHandle &handle, const Eigen::VectorXd &values);
+
+        /**
+         * @brief Shift the warm start values of a block of variables by one stage.
+         * 
+         * @details The columns of the block are the stages of a receding horizon. Each column takes the
+         * values of the next column and the last column keeps its values.
+         * 
+         * @param block The variables with one column per stage
+         */
+        void shiftPrimalGuess(const MatrixX &block);
+
+        /**
+         * @brief Shift the warm start duals of a constraint handle by one stage.
+         * 
+         * @details The constraints of the handle are interpreted as a matrix with one column per stage
+         * in row-major order, which is the order of the constraints created from a matrix.
+         * Each stage takes the duals of the next stage and the last stage keeps its duals.
+         * All constraints of the handle have to be of the same type and have created the same number of rows.
+         * 
+         * @param handle The constraint handle
+         * @param num_stages The number of stages
+         */
+        void shiftDualGuess(const ConstraintHandle &handle, size_t num_stages);
+
+        /**
+         * @brief Map the primal warm start values to the solver variables, applying the presolve if necessary.
+         * 
+         */
+        Eigen::VectorXd getSolverPrimalGuess() const;
+
+        /**
+         * @brief Map the dual warm start values to the solver rows, applying the presolve if necessary.
+         * 
+         */
+        Eigen::VectorXd getSolverDualGuess() const;
+
+        /**
+         * @brief Get the index of a single variable of this solver.
+         * 
+         * @return false if the entry is not a single variable of this solver
+         */
+        bool getGuessIndex(const Scalar &entry, size_t &index) const;
 
         virtual void addVariable(Variable &variable) = 0;
 
+        /**
+         * @brief Add the coefficients of a list with a single column to a vector. Duplicates are merged into a single sum.
+         * 
+         */
+        static void addCoefficients(CoefficientList &coeffs, VectorXp &vector);
+
+        /**
+         * @brief Replace piecewise linear terms with slack variables.
+         * 
+         * @details The rows slack - term >= 0, and slack + term >= 0 for 1-norms, are appended to rows.
+         * A maximum uses one slack variable, a 1-norm uses one per term.
+         * 
+         * @param piecewise_linear The piecewise linear terms
+         * @param rows The rows that have to be nonnegative
+         * @return Affine The weighted sum of the slack variables
+         */
+        Affine addSlacks(const std::vector<PiecewiseLinear> &piecewise_linear, std::vector<Affine> &rows);
+
+        /**
+         * @brief Count the rows and nonzeros that addSlacks() creates, including the slack variables in the returned sum.
+         * 
+         * @details Used to reserve the storage before the constraints are canonicalized.
+         */
+        static void countSlacks(const std::vector<PiecewiseLinear> &piecewise_linear, size_t &num_rows, size_t &num_nonzeros);
+
+        /**
+         * @brief Count the linear and quadratic coefficients of a cost term to reserve the storage.
+         * 
+         * @details These are upper bounds, e.g. lifted squares need fewer coefficients.
+         */
+        static void countCost(const Scalar &cost, size_t &num_linear, size_t &num_quadratic);
+
+        /**
+         * @brief Throw if a piecewise linear cost term has a negative constant weight and is not convex.
+         * 
+         */
+        static void checkPiecewiseLinearCost(const std::vector<PiecewiseLinear> &piecewise_linear);
+
+        /**
+         * @brief Set up the solver workspace again after the problem structure has changed.
+         * 
+         */
+        virtual void rebuildWorkspace() = 0;
+
+        /**
+         * @brief Add a row to the last block if it continues it, otherwise start a new block.
+         * 
+         * @param blocks The row blocks
+         * @param source The source of the constraint of the row
+         * @param row The index of the row
+         * @param type The type of the constraint
+         * @param constraint_rows The number of rows that the constraint creates
+         */
+        static void addRowToBlocks(std::vector<RowBlock> &blocks,
+                                   const std::shared_ptr<ConstraintSource> &source,
+                                   size_t row,
+                                   Constraint::Type type,
+                                   size_t constraint_rows);
+
     private:
         WrapperBase(const WrapperBase &);
         static size_t solver_count;
+        size_t num_slacks = 0;
     };
 
 } // namespace cvx::internal
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "builder.hpp"
+
+#include <atomic>
+#include <iterator>
+#include <limits>
+
+namespace cvx
+{
+    using namespace internal;
+
+    namespace
+    {
+        std::atomic<size_t> next_builder_id{0};
+
+        template <typename T>
+        void moveAppend(std::vector<T> &source, std::vector<T> &destination)
+        {
+            destination.reserve(destination.size() + source.size());
+            std::move(source.begin(), source.end(), std::back_inserter(destination));
+            source.clear();
+        }
+    } // namespace
+
+    ProblemBuilder::ProblemBuilder(OptimizationProblem &problem)
+        : problem(problem), id(next_builder_id++) {}
+
+    Scalar ProblemBuilder::addVariable(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return problem.addVariable(name);
+    }
+
+    VectorX ProblemBuilder::addVariable(const std::string &name, size_t rows)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return problem.addVariable(name, rows);
+    }
+
+    MatrixX ProblemBuilder::addVariable(const std::string &name, size_t rows, size_t cols)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return problem.addVariable(name, rows, cols);
+    }
+
+    ConstraintHandle ProblemBuilder::addConstraint(const Constraint &constraint)
+    {
+        return getBuffer().addConstraint(constraint);
+    }
+
+    ConstraintHandle ProblemBuilder::addConstraint(const std::vector<Constraint> &constraints)
+    {
+        return getBuffer().addConstraint(constraints);
+    }
+
+    void ProblemBuilder::addCostTerm(const Scalar &term)
+    {
+        getBuffer().addCostTerm(term);
+    }
+
+    void ProblemBuilder::commit()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (std::unique_ptr<OptimizationProblem> &buffer : buffers)
+        {
+            moveAppend(buffer->equality_constraints, problem.equality_constraints);
+            moveAppend(buffer->positive_constraints, problem.positive_constraints);
+            moveAppend(buffer->box_constraints, problem.box_constraints);
+            moveAppend(buffer->second_order_cone_constraints, problem.second_order_cone_constraints);
+            moveAppend(buffer->rotated_second_order_cone_constraints, problem.rotated_second_order_cone_constraints);
+
+            if (buffer->cost_revision > 0)
+            {
+                problem.addCostTerm(buffer->costFunction);
+                buffer->costFunction = Scalar();
+                buffer->cost_revision = 0;
+            }
+        }
+    }
+
+    OptimizationProblem &ProblemBuilder::getBuffer()
+    {
+        // The buffer of the builder that this thread has used last
+        thread_local size_t cached_id = std::numeric_limits<size_t>::max();
+        thread_local OptimizationProblem *cached_buffer = nullptr;
+
+        if (cached_id == id)
+        {
+            return *cached_buffer;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = thread_buffers.find(std::this_thread::get_id());
+        if (found == thread_buffers.end())
+        {
+            buffers.push_back(std::make_unique<OptimizationProblem>());
+            found = thread_buffers.emplace(std::this_thread::get_id(), buffers.back().get()).first;
+        }
+
+        cached_id = id;
+        cached_buffer = found->second;
+        return *cached_buffer;
+    }
+
+} // namespace cvx
@@ -13,7 +13,21 @@ namespace cvx
 
         std::ostream &operator<<(std::ostream &os, const PositiveConstraint &constraint)
         {
-            os << "0 <= " << constraint.affine;
+            if (constraint.piecewise_linear.empty())
+            {
+                os << "0 <= " << constraint.affine;
+                return os;
+            }
+
+            for (size_t i = 0; i < constraint.piecewise_linear.size(); i++)
+            {
+                os << constraint.piecewise_linear[i];
+                if (i != constraint.piecewise_linear.size() - 1)
+                {
+                    os << " + ";
+                }
+            }
+            os << " <= " << constraint.affine;
             return os;
         }
 
@@ -40,6 +54,22 @@ namespace cvx
 
             return os;
         }
+
+        std::ostream &operator<<(std::ostream &os, const RotatedSecondOrderConeConstraint &constraint)
+        {
+            for (size_t i = 0; i < constraint.norm.size(); i++)
+            {
+                os << "(" << constraint.norm[i] << ")^2";
+                if (i != constraint.norm.size() - 1)
+                {
+                    os << " + ";
+                }
+            }
+
+            os << " <= (" << constraint.first_factor << ") * (" << constraint.second_factor << ")";
+
+            return os;
+        }
     } // namespace internal
 
     using namespace internal;
@@ -60,6 +90,9 @@ namespace cvx
         case Constraint::Type::SecondOrderCone:
             os << std::get<Constraint::Type::SecondOrderCone>(constraint.data);
             break;
+        case Constraint::Type::RotatedSecondOrderCone:
+            os << std::get<Constraint::Type::RotatedSecondOrderCone>(constraint.data);
+            break;
         }
         return os;
     }
@@ -77,11 +110,12 @@ namespace cvx
         data = constraint;
     }
 
-    // affine >= 0
-    void Constraint::asPositive(const Affine &affine)
+    // piecewise_linear <= affine
+    void Constraint::asPositive(const Affine &affine, const std::vector<PiecewiseLinear> &piecewise_linear)
     {
         internal::PositiveConstraint constraint;
         constraint.affine = affine;
+        constraint.piecewise_linear = piecewise_linear;
         data = constraint;
     }
 
@@ -104,6 +138,46 @@ namespace cvx
         data = constraint;
     }
 
+    // norm^2 <= first_factor * second_factor
+    void Constraint::asRotatedSecondOrderCone(const std::vector<Affine> &norm,
+                                              const Affine &first_factor,
+                                              const Affine &second_factor)
+    {
+        internal::RotatedSecondOrderConeConstraint constraint;
+        constraint.norm = norm;
+        constraint.first_factor = first_factor;
+        constraint.second_factor = second_factor;
+        data = constraint;
+    }
+
+    void ConstraintHandle::enable()
+    {
+        setEnabled(true);
+    }
+
+    void ConstraintHandle::disable()
+    {
+        setEnabled(false);
+    }
+
+    void ConstraintHandle::setEnabled(bool enabled)
+    {
+        if (not source)
+        {
+            throw std::runtime_error("The constraint handle is not associated with a problem.");
+        }
+        source->enabled = enabled;
+    }
+
+    bool ConstraintHandle::isEnabled() const
+    {
+        if (not source)
+        {
+            throw std::runtime_error("The constraint handle is not associated with a problem.");
+        }
+        return source->enabled;
+    }
+
     Constraint equalTo(const Scalar &lhs, const Scalar &rhs)
     {
         if (lhs.getOrder() > 1 or rhs.getOrder() > 1)
@@ -117,6 +191,63 @@ namespace cvx
 
     Constraint lessThan(const Scalar &lhs, const Scalar &rhs)
     {
+        if (not lhs.piecewise_linear.empty())
+        {
+            if (not lhs.products.empty() or not lhs.quad_forms.empty() or rhs.getOrder() > 1)
+            {
+                throw std::runtime_error("Piecewise linear terms can only be less than a constant or linear term.");
+            }
+            for (const PiecewiseLinear &piecewise_linear : lhs.piecewise_linear)
+            {
+                if (piecewise_linear.weight.isConstant() and piecewise_linear.weight.getValue() < 0.)
+                {
+                    throw std::runtime_error("Piecewise linear terms on the smaller side of an inequality must have a nonnegative weight.");
+                }
+            }
+
+            Constraint constraint;
+            constraint.asPositive(rhs.affine - lhs.affine, lhs.piecewise_linear);
+            return constraint;
+        }
+
+        if (lhs.getOrder() == 2 and not lhs.isNorm())
+        {
+            // Rotated cone: sum of squares <= product of linear terms
+            bool is_sum_of_squares = lhs.quad_forms.empty();
+            std::vector<Affine> norm2_terms;
+            for (Product product : lhs.products)
+            {
+                product.toSquaredTerm();
+                is_sum_of_squares &= product.isSquare();
+                norm2_terms.push_back(product.firstTerm());
+            }
+
+            Constraint constraint;
+            if (is_sum_of_squares and rhs.getOrder() < 2)
+            {
+                // ||x||^2 + a <= b
+                constraint.asRotatedSecondOrderCone(norm2_terms, rhs.affine - lhs.affine, Affine(Parameter(1.)));
+            }
+            else if (is_sum_of_squares and
+                     lhs.affine.isZero() and
+                     rhs.affine.isZero() and
+                     rhs.quad_forms.empty() and
+                     rhs.products.size() == 1 and
+                     not rhs.products.front().isSquare())
+            {
+                // ||x||^2 <= t * s
+                constraint.asRotatedSecondOrderCone(norm2_terms,
+                                                    rhs.products.front().firstTerm(),
+                                                    rhs.products.front().secondTerm());
+            }
+            else
+            {
+                throw std::runtime_error("A quadratic term in an inequality has to be a sum of squares "
+                                         "that is less than a linear term or a product of two linear terms.");
+            }
+            return constraint;
+        }
+
         if (rhs.getOrder() > 1)
         {
             throw std::runtime_error("The larger term in an inequality has to be constant or linear.");
@@ -126,6 +257,7 @@ namespace cvx
         if (lhs.isNorm())
         {
             std::vector<Affine> norm2_terms;
+            norm2_terms.reserve(lhs.products.size());
             for (const Product &product : lhs.products)
             {
                 norm2_terms.push_back(product.firstTerm());
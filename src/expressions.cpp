@@ -1,5 +1,9 @@
 #include "expressions.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 namespace cvx
 {
     namespace internal
@@ -49,6 +53,38 @@ namespace cvx
 
             return os;
         }
+
+        std::ostream &operator<<(std::ostream &os, const QuadForm &quad_form)
+        {
+            os << "quad_form([";
+            for (size_t i = 0; i < quad_form.x.size(); i++)
+            {
+                os << quad_form.x[i];
+                if (i != quad_form.x.size() - 1)
+                    os << ", ";
+            }
+            os << "], " << quad_form.Q.nonZeros() << " nonzeros)";
+
+            return os;
+        }
+
+        std::ostream &operator<<(std::ostream &os, const PiecewiseLinear &piecewise_linear)
+        {
+            if (not piecewise_linear.weight.isOne())
+            {
+                os << piecewise_linear.weight << " * ";
+            }
+            os << (piecewise_linear.type == PiecewiseLinear::Type::Max ? "max(" : "norm1(");
+            for (size_t i = 0; i < piecewise_linear.terms.size(); i++)
+            {
+                os << piecewise_linear.terms[i];
+                if (i != piecewise_linear.terms.size() - 1)
+                    os << ", ";
+            }
+            os << ")";
+
+            return os;
+        }
     } // namespace internal
 
     using namespace internal;
@@ -77,7 +113,23 @@ namespace cvx
                 os << ")^(1/2)";
             }
         }
-        if (not exp.affine.isZero() and not exp.products.empty())
+        for (size_t i = 0; i < exp.quad_forms.size(); i++)
+        {
+            if (i > 0 or not exp.products.empty())
+            {
+                os << " + ";
+            }
+            os << exp.quad_forms[i];
+        }
+        for (size_t i = 0; i < exp.piecewise_linear.size(); i++)
+        {
+            if (i > 0 or not exp.products.empty() or not exp.quad_forms.empty())
+            {
+                os << " + ";
+            }
+            os << exp.piecewise_linear[i];
+        }
+        if (not exp.affine.isZero() and exp.getOrder() == 2)
         {
             os << " + ";
         }
@@ -369,6 +421,85 @@ namespace cvx
         return factors.size() == 1;
     }
 
+    // QuadForm
+
+    QuadForm::QuadForm(const std::vector<Affine> &x, const Eigen::SparseMatrix<Parameter> &Q)
+        : x(x), Q(Q) {}
+
+    double QuadForm::evaluate() const
+    {
+        double sum = 0.;
+
+        for (int k = 0; k < Q.outerSize(); k++)
+        {
+            for (Eigen::SparseMatrix<Parameter>::InnerIterator it(Q, k); it; ++it)
+            {
+                const double factor = it.row() == it.col() ? 1. : 2.;
+                sum += factor * it.value().getValue() * x[it.row()].evaluate() * x[it.col()].evaluate();
+            }
+        }
+
+        return sum;
+    }
+
+    bool QuadForm::operator==(const QuadForm &other) const
+    {
+        if (this->x.size() != other.x.size() or this->Q.nonZeros() != other.Q.nonZeros())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < this->x.size(); i++)
+        {
+            if (not(this->x[i] == other.x[i]))
+            {
+                return false;
+            }
+        }
+        for (int k = 0; k < Q.outerSize(); k++)
+        {
+            Eigen::SparseMatrix<Parameter>::InnerIterator other_it(other.Q, k);
+            for (Eigen::SparseMatrix<Parameter>::InnerIterator it(Q, k); it; ++it, ++other_it)
+            {
+                if (not other_it or it.row() != other_it.row() or not(it.value() == other_it.value()))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // PiecewiseLinear
+
+    PiecewiseLinear::PiecewiseLinear(Type type, const std::vector<Affine> &terms)
+        : type(type), terms(terms) {}
+
+    double PiecewiseLinear::evaluate() const
+    {
+        double value = type == Type::Max ? -std::numeric_limits<double>::infinity() : 0.;
+
+        for (const Affine &term : terms)
+        {
+            if (type == Type::Max)
+            {
+                value = std::max(value, term.evaluate());
+            }
+            else
+            {
+                value += std::abs(term.evaluate());
+            }
+        }
+
+        return weight.getValue() * value;
+    }
+
+    bool PiecewiseLinear::operator==(const PiecewiseLinear &other) const
+    {
+        return this->type == other.type and
+               this->terms == other.terms and
+               this->weight == other.weight;
+    }
+
     // Scalar
 
     Scalar::Scalar(int x)
@@ -392,6 +523,8 @@ namespace cvx
 
         equal &= this->affine == other.affine;
         equal &= this->products == other.products;
+        equal &= this->quad_forms == other.quad_forms;
+        equal &= this->piecewise_linear == other.piecewise_linear;
         equal &= this->norm == other.norm;
 
         return equal;
@@ -411,6 +544,16 @@ namespace cvx
             sum = std::sqrt(sum);
         }
 
+        for (const QuadForm &quad_form : this->quad_forms)
+        {
+            sum += quad_form.evaluate();
+        }
+
+        for (const PiecewiseLinear &piecewise_linear : this->piecewise_linear)
+        {
+            sum += piecewise_linear.evaluate();
+        }
+
         sum += this->affine.evaluate();
 
         return sum;
@@ -436,6 +579,14 @@ namespace cvx
                               other.products.cbegin(),
                               other.products.cend());
 
+        this->quad_forms.insert(this->quad_forms.end(),
+                                other.quad_forms.cbegin(),
+                                other.quad_forms.cend());
+
+        this->piecewise_linear.insert(this->piecewise_linear.end(),
+                                      other.piecewise_linear.cbegin(),
+                                      other.piecewise_linear.cend());
+
         return *this;
     }
 
@@ -453,6 +604,25 @@ namespace cvx
 
     Scalar &Scalar::operator*=(const Scalar &other)
     {
+        // Piecewise linear terms can be scaled with parameters
+        auto is_piecewise_linear = [](const Scalar &scalar) {
+            return not scalar.piecewise_linear.empty() and scalar.products.empty() and scalar.quad_forms.empty();
+        };
+        if ((is_piecewise_linear(*this) and other.getOrder() == 0) or
+            (this->getOrder() == 0 and is_piecewise_linear(other)))
+        {
+            Scalar result = this->getOrder() == 0 ? other : *this;
+            const Parameter factor = this->getOrder() == 0 ? this->affine.constant : other.affine.constant;
+
+            result.affine *= factor;
+            for (PiecewiseLinear &piecewise_linear : result.piecewise_linear)
+            {
+                piecewise_linear.weight *= factor;
+            }
+            *this = result;
+            return *this;
+        }
+
         if (this->getOrder() == 2 or other.getOrder() == 2)
         {
             // TODO: Maybe allow scaling sums of squares, but not norms for performance reasons
@@ -535,7 +705,7 @@ namespace cvx
 
     size_t Scalar::getOrder() const
     {
-        if (not this->products.empty())
+        if (not this->products.empty() or not this->quad_forms.empty() or not this->piecewise_linear.empty())
         {
             return 2;
         }
@@ -554,8 +724,22 @@ namespace cvx
         return this->norm;
     }
 
+    bool Scalar::isZero() const
+    {
+        return this->getOrder() == 0 and not this->norm and this->affine.isZero();
+    }
+
     Scalar sqrt(const Scalar &scalar)
     {
+        if (not scalar.quad_forms.empty())
+        {
+            throw std::runtime_error("Can not take the square root of a quadratic form.");
+        }
+        if (not scalar.piecewise_linear.empty())
+        {
+            throw std::runtime_error("Can not take the square root of a piecewise linear term.");
+        }
+
         // Turn all higher order terms into squared terms
         Scalar e = scalar;
 
@@ -581,12 +765,12 @@ namespace cvx
         return e;
     }
 
-    // Parameter::operator Scalar() const
-    // {
-    //     Scalar scalar;
-    //     scalar.affine.constant = *this;
-    //     return scalar;
-    // }
+    Parameter::operator Scalar() const
+    {
+        Scalar scalar;
+        scalar.affine.constant = *this;
+        return scalar;
+    }
 
     Variable::operator Scalar() const
     {
@@ -610,4 +794,185 @@ namespace cvx
         return double(s);
     }
 
+    Scalar norm2(const VectorX &x)
+    {
+        Scalar result;
+        result.products.reserve(x.rows());
+        for (int i = 0; i < x.rows(); i++)
+        {
+            if (x(i).getOrder() > 1)
+            {
+                throw std::runtime_error("The elements of a 2-norm have to be constant or linear.");
+            }
+            result.products.emplace_back(x(i).affine);
+        }
+        result.norm = true;
+        return result;
+    }
+
+    VectorX colwiseNorm2(const MatrixX &m)
+    {
+        VectorX result(m.cols());
+        for (int col = 0; col < m.cols(); col++)
+        {
+            Scalar &norm = result(col);
+            norm.products.reserve(m.rows());
+            for (int row = 0; row < m.rows(); row++)
+            {
+                if (m(row, col).getOrder() > 1)
+                {
+                    throw std::runtime_error("The elements of a 2-norm have to be constant or linear.");
+                }
+                norm.products.emplace_back(m(row, col).affine);
+            }
+            norm.norm = true;
+        }
+        return result;
+    }
+
+    VectorX rowwiseNorm2(const MatrixX &m)
+    {
+        VectorX result(m.rows());
+        for (int row = 0; row < m.rows(); row++)
+        {
+            Scalar &norm = result(row);
+            norm.products.reserve(m.cols());
+            for (int col = 0; col < m.cols(); col++)
+            {
+                if (m(row, col).getOrder() > 1)
+                {
+                    throw std::runtime_error("The elements of a 2-norm have to be constant or linear.");
+                }
+                norm.products.emplace_back(m(row, col).affine);
+            }
+            norm.norm = true;
+        }
+        return result;
+    }
+
+    Scalar norm1(const VectorX &x)
+    {
+        std::vector<Affine> terms;
+        terms.reserve(x.rows());
+        for (int i = 0; i < x.rows(); i++)
+        {
+            if (x(i).getOrder() > 1)
+            {
+                throw std::runtime_error("The elements of a piecewise linear term have to be constant or linear.");
+            }
+            terms.push_back(x(i).affine);
+        }
+
+        Scalar result;
+        result.piecewise_linear.emplace_back(PiecewiseLinear::Type::Norm1, terms);
+        return result;
+    }
+
+    Scalar normInf(const VectorX &x)
+    {
+        // max(x, -x)
+        Scalar result = max(x);
+        std::vector<Affine> &terms = result.piecewise_linear.front().terms;
+        terms.reserve(2 * terms.size());
+        for (int i = 0; i < x.rows(); i++)
+        {
+            terms.push_back(-terms[i]);
+        }
+        return result;
+    }
+
+    Scalar max(const VectorX &x)
+    {
+        if (x.rows() == 0)
+        {
+            throw std::runtime_error("Can not take the maximum of an empty vector.");
+        }
+
+        Scalar result = norm1(x);
+        result.piecewise_linear.front().type = PiecewiseLinear::Type::Max;
+        return result;
+    }
+
+    Scalar abs(const Scalar &x)
+    {
+        if (x.getOrder() > 1)
+        {
+            throw std::runtime_error("The argument of abs() has to be constant or linear.");
+        }
+
+        Scalar result;
+        result.piecewise_linear.emplace_back(PiecewiseLinear::Type::Norm1, std::vector<Affine>{x.affine});
+        return result;
+    }
+
+    Scalar pos(const Scalar &x)
+    {
+        if (x.getOrder() > 1)
+        {
+            throw std::runtime_error("The argument of pos() has to be constant or linear.");
+        }
+
+        Scalar result;
+        result.piecewise_linear.emplace_back(PiecewiseLinear::Type::Max, std::vector<Affine>{x.affine, Affine()});
+        return result;
+    }
+
+    Scalar quad_form(const VectorX &x, const Eigen::SparseMatrix<Scalar> &Q)
+    {
+        if (Q.rows() != x.rows() or Q.cols() != x.rows())
+        {
+            throw std::runtime_error("The matrix of a quadratic form must be square and match the vector.");
+        }
+
+        std::vector<Affine> x_affine;
+        x_affine.reserve(x.rows());
+        for (int i = 0; i < x.rows(); i++)
+        {
+            if (x(i).getOrder() > 1 or x(i).affine.terms.size() > 1)
+            {
+                throw std::runtime_error("Each element in a quadratic form must contain at most one variable.");
+            }
+            x_affine.push_back(x(i).affine);
+        }
+
+        std::vector<Eigen::Triplet<Parameter>> Q_coeffs;
+        for (int k = 0; k < Q.outerSize(); k++)
+        {
+            for (Eigen::SparseMatrix<Scalar>::InnerIterator it(Q, k); it; ++it)
+            {
+                if (it.value().getOrder() > 0)
+                {
+                    throw std::runtime_error("The matrix of a quadratic form must only contain parameters.");
+                }
+                if (it.row() <= it.col() and not it.value().affine.constant.isZero())
+                {
+                    Q_coeffs.emplace_back(it.row(), it.col(), it.value().affine.constant);
+                }
+            }
+        }
+
+        Eigen::SparseMatrix<Parameter> Q_upper(Q.rows(), Q.cols());
+        Q_upper.setFromTriplets(Q_coeffs.begin(), Q_coeffs.end());
+
+        Scalar result;
+        result.quad_forms.emplace_back(x_affine, Q_upper);
+        return result;
+    }
+
+    Scalar quad_form(const VectorX &x, const MatrixX &Q)
+    {
+        std::vector<Eigen::Triplet<Scalar>> Q_coeffs;
+        for (int col = 0; col < Q.cols(); col++)
+        {
+            for (int row = 0; row <= std::min<int>(col, Q.rows() - 1); row++)
+            {
+                Q_coeffs.emplace_back(row, col, Q(row, col));
+            }
+        }
+
+        Eigen::SparseMatrix<Scalar> Q_sparse(Q.rows(), Q.cols());
+        Q_sparse.setFromTriplets(Q_coeffs.begin(), Q_coeffs.end());
+        return quad_form(x, Q_sparse);
+    }
+
 } // namespace cvx
\ No newline at end of file
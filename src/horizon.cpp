@@ -0,0 +1,77 @@
+#include "horizon.hpp"
+
+namespace cvx
+{
+
+    HorizonParameter::HorizonParameter(const Eigen::MatrixXd &values)
+        : storage(std::make_shared<internal::RingStorage>())
+    {
+        storage->data.assign(values.data(), values.data() + values.size());
+        storage->rows = values.rows();
+        storage->cols = values.cols();
+    }
+
+    size_t HorizonParameter::rows() const
+    {
+        return storage->rows;
+    }
+
+    size_t HorizonParameter::stages() const
+    {
+        return storage->cols;
+    }
+
+    void HorizonParameter::shift()
+    {
+        if (storage->cols > 0)
+        {
+            storage->head = (storage->head + 1) % storage->cols;
+        }
+    }
+
+    void HorizonParameter::setStage(size_t stage, const Eigen::VectorXd &values)
+    {
+        if (stage >= stages() or size_t(values.size()) != rows())
+        {
+            throw std::runtime_error("Invalid stage or number of values for the horizon parameter.");
+        }
+
+        const size_t col = (storage->head + stage) % storage->cols;
+        std::copy_n(values.data(), rows(), storage->data.begin() + col * rows());
+    }
+
+    Eigen::VectorXd HorizonParameter::getStage(size_t stage) const
+    {
+        if (stage >= stages())
+        {
+            throw std::runtime_error("Invalid stage for the horizon parameter.");
+        }
+
+        const size_t col = (storage->head + stage) % storage->cols;
+        return Eigen::Map<const Eigen::VectorXd>(storage->data.data() + col * rows(), rows());
+    }
+
+    Eigen::MatrixXd HorizonParameter::getValues() const
+    {
+        Eigen::MatrixXd values(rows(), stages());
+        for (size_t stage = 0; stage < stages(); stage++)
+        {
+            values.col(stage) = getStage(stage);
+        }
+        return values;
+    }
+
+    MatrixX dynpar(const HorizonParameter &p)
+    {
+        MatrixX result(p.rows(), p.stages());
+        for (size_t row = 0; row < p.rows(); row++)
+        {
+            for (size_t col = 0; col < p.stages(); col++)
+            {
+                result(row, col) = Scalar(internal::Parameter(p.storage, row, col));
+            }
+        }
+        return result;
+    }
+
+} // namespace cvx
@@ -0,0 +1,94 @@
+#include "operators.hpp"
+
+namespace cvx
+{
+
+    LinearOperator identity(size_t size)
+    {
+        LinearOperator op(size, size);
+        op.setIdentity();
+        return op;
+    }
+
+    LinearOperator diagonal(const VectorX &d)
+    {
+        std::vector<Eigen::Triplet<Scalar>> triplets;
+        triplets.reserve(d.size());
+        for (int i = 0; i < d.size(); i++)
+        {
+            if (not d(i).isZero())
+            {
+                triplets.emplace_back(i, i, d(i));
+            }
+        }
+
+        LinearOperator op(d.size(), d.size());
+        op.setFromTriplets(triplets.begin(), triplets.end());
+        return op;
+    }
+
+    LinearOperator shift(size_t size, int offset)
+    {
+        std::vector<Eigen::Triplet<Scalar>> triplets;
+        triplets.reserve(size);
+        for (int row = 0; row < int(size); row++)
+        {
+            const int col = row + offset;
+            if (col >= 0 and col < int(size))
+            {
+                triplets.emplace_back(row, col, Scalar(1.));
+            }
+        }
+
+        LinearOperator op(size, size);
+        op.setFromTriplets(triplets.begin(), triplets.end());
+        return op;
+    }
+
+    LinearOperator kron(const LinearOperator &lhs, const LinearOperator &rhs)
+    {
+        std::vector<Eigen::Triplet<Scalar>> triplets;
+        triplets.reserve(lhs.nonZeros() * rhs.nonZeros());
+        for (int k = 0; k < lhs.outerSize(); k++)
+        {
+            for (LinearOperator::InnerIterator lhs_it(lhs, k); lhs_it; ++lhs_it)
+            {
+                for (int l = 0; l < rhs.outerSize(); l++)
+                {
+                    for (LinearOperator::InnerIterator rhs_it(rhs, l); rhs_it; ++rhs_it)
+                    {
+                        triplets.emplace_back(lhs_it.row() * rhs.rows() + rhs_it.row(),
+                                              lhs_it.col() * rhs.cols() + rhs_it.col(),
+                                              lhs_it.value() * rhs_it.value());
+                    }
+                }
+            }
+        }
+
+        LinearOperator op(lhs.rows() * rhs.rows(), lhs.cols() * rhs.cols());
+        op.setFromTriplets(triplets.begin(), triplets.end());
+        return op;
+    }
+
+    LinearOperator kron(const LinearOperator &lhs, const MatrixX &rhs)
+    {
+        std::vector<Eigen::Triplet<Scalar>> triplets;
+        triplets.reserve(rhs.size());
+        for (int row = 0; row < rhs.rows(); row++)
+        {
+            for (int col = 0; col < rhs.cols(); col++)
+            {
+                // Constant zeros would be repeated in every block
+                if (not rhs(row, col).isZero())
+                {
+                    triplets.emplace_back(row, col, rhs(row, col));
+                }
+            }
+        }
+
+        LinearOperator rhs_op(rhs.rows(), rhs.cols());
+        rhs_op.setFromTriplets(triplets.begin(), triplets.end());
+        return kron(lhs, rhs_op);
+    }
+
+} // namespace cvx
@@ -3,6 +3,7 @@
 #include <sstream>
 #include <cassert>
 #include <cmath>
+#include <algorithm>
 
 namespace cvx::internal
 {
@@ -18,6 +19,12 @@ namespace cvx::internal
                                      std::shared_ptr<ParameterSource> p2)
         : op(op), p1(p1), p2(p2) {}
 
+    SumSource::SumSource(std::vector<std::shared_ptr<ParameterSource>> terms)
+        : terms(std::move(terms)) {}
+
+    RingSource::RingSource(std::shared_ptr<const RingStorage> storage, size_t row, size_t col)
+        : storage(std::move(storage)), row(row), col(col) {}
+
     ParameterType ConstantSource::getType() const
     {
         return ParameterType::Constant;
@@ -31,6 +38,16 @@ namespace cvx::internal
         return ParameterType::Operation;
     }
 
+    ParameterType SumSource::getType() const
+    {
+        return ParameterType::Sum;
+    }
+
+    ParameterType RingSource::getType() const
+    {
+        return ParameterType::Ring;
+    }
+
     double ConstantSource::getValue() const
     {
         return value;
@@ -55,10 +72,31 @@ namespace cvx::internal
             assert(p2->getValue() != 0.);
             return p1->getValue() /
                    p2->getValue();
-        default: // ParamOpcode::Sqrt:
+        case ParamOpcode::Sqrt:
             assert(p1->getValue() >= 0.);
             return std::sqrt(p1->getValue());
+        case ParamOpcode::Max:
+            return std::max(p1->getValue(),
+                            p2->getValue());
+        default: // ParamOpcode::Min:
+            return std::min(p1->getValue(),
+                            p2->getValue());
+        }
+    }
+
+    double SumSource::getValue() const
+    {
+        double value = 0.;
+        for (const std::shared_ptr<ParameterSource> &term : terms)
+        {
+            value += term->getValue();
         }
+        return value;
+    }
+
+    double RingSource::getValue() const
+    {
+        return storage->data[((storage->head + col) % storage->cols) * storage->rows + row];
     }
 
     Parameter::Parameter()
@@ -81,6 +119,11 @@ namespace cvx::internal
     {
     }
 
+    Parameter::Parameter(std::shared_ptr<const RingStorage> storage, size_t row, size_t col)
+        : source(std::make_shared<RingSource>(std::move(storage), row, col))
+    {
+    }
+
     double Parameter::getValue() const
     {
         return source->getValue();
@@ -109,6 +152,16 @@ namespace cvx::internal
                 return *std::dynamic_pointer_cast<OperationSource>(p1) ==
                        *std::dynamic_pointer_cast<OperationSource>(p2);
             }
+            else if (p1->getType() == ParameterType::Sum)
+            {
+                return *std::dynamic_pointer_cast<SumSource>(p1) ==
+                       *std::dynamic_pointer_cast<SumSource>(p2);
+            }
+            else if (p1->getType() == ParameterType::Ring)
+            {
+                return *std::dynamic_pointer_cast<RingSource>(p1) ==
+                       *std::dynamic_pointer_cast<RingSource>(p2);
+            }
         }
 
         return false;
@@ -131,6 +184,8 @@ namespace cvx::internal
             {
             case ParamOpcode::Add:
             case ParamOpcode::Mul:
+            case ParamOpcode::Max:
+            case ParamOpcode::Min:
                 return ((compare_sources(this->p1, other.p1) and compare_sources(this->p2, other.p2)) or
                         (compare_sources(this->p1, other.p2) and compare_sources(this->p2, other.p1)));
             case ParamOpcode::Div:
@@ -142,6 +197,27 @@ namespace cvx::internal
         return false;
     }
 
+    bool SumSource::operator==(const SumSource &other) const
+    {
+        if (this->terms.size() != other.terms.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < terms.size(); i++)
+        {
+            if (not compare_sources(this->terms[i], other.terms[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool RingSource::operator==(const RingSource &other) const
+    {
+        return this->storage == other.storage and this->row == other.row and this->col == other.col;
+    }
+
     bool Parameter::operator==(const Parameter &other) const
     {
         return compare_sources(this->source, other.source);
@@ -174,6 +250,11 @@ namespace cvx::internal
         return source->getType() == ParameterType::Constant and getValue() == 1.;
     }
 
+    bool Parameter::isConstant() const
+    {
+        return source->getType() == ParameterType::Constant;
+    }
+
     Parameter Parameter::operator+(const Parameter &other) const
     {
         Parameter result = *this;
@@ -232,11 +313,11 @@ namespace cvx::internal
 
     Parameter &Parameter::operator*=(const Parameter &other)
     {
-        if (this->isZero())
+        if (this->isZero() or other.isOne())
         {
             return *this;
         }
-        else if (other.isZero())
+        else if (other.isZero() or this->isOne())
         {
             this->source = other.source;
             return *this;
@@ -280,6 +361,42 @@ namespace cvx::internal
         }
     }
 
+    Parameter sum(const std::vector<Parameter> &params)
+    {
+        double constant = 0.;
+        std::vector<std::shared_ptr<ParameterSource>> terms;
+        for (const Parameter &param : params)
+        {
+            if (param.isConstant())
+            {
+                constant += param.getValue();
+            }
+            else
+            {
+                terms.push_back(param.source);
+            }
+        }
+
+        if (terms.empty())
+        {
+            return Parameter(constant);
+        }
+        if (constant != 0.)
+        {
+            terms.push_back(std::make_shared<ConstantSource>(constant));
+        }
+        if (terms.size() == 1)
+        {
+            Parameter result;
+            result.source = terms.front();
+            return result;
+        }
+
+        Parameter result;
+        result.source = std::make_shared<SumSource>(std::move(terms));
+        return result;
+    }
+
     Parameter sqrt(const Parameter &param)
     {
         if (param.isZero())
@@ -303,4 +420,40 @@ namespace cvx::internal
         }
     }
 
-} // namespace cvx
\ No newline at end of file
+    Parameter max(const Parameter &p1, const Parameter &p2)
+    {
+        if (p1.isConstant() and p2.isConstant())
+        {
+            return Parameter(std::max(p1.getValue(), p2.getValue()));
+        }
+        else if (p1 == p2)
+        {
+            return p1;
+        }
+        else
+        {
+            Parameter param_max;
+            param_max.source = std::make_shared<OperationSource>(ParamOpcode::Max, p1.source, p2.source);
+            return param_max;
+        }
+    }
+
+    Parameter min(const Parameter &p1, const Parameter &p2)
+    {
+        if (p1.isConstant() and p2.isConstant())
+        {
+            return Parameter(std::min(p1.getValue(), p2.getValue()));
+        }
+        else if (p1 == p2)
+        {
+            return p1;
+        }
+        else
+        {
+            Parameter param_min;
+            param_min.source = std::make_shared<OperationSource>(ParamOpcode::Min, p1.source, p2.source);
+            return param_min;
+        }
+    }
+
+} // namespace cvx
@@ -1,5 +1,8 @@
 #include "problem.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 namespace cvx
 {
     using namespace internal;
@@ -42,11 +45,7 @@ namespace cvx
                                              size_t rows,
                                              size_t cols)
     {
-        if (matrix_variables.find(name) != matrix_variables.end())
-        {
-            const std::string error_message = "Could not add matrix variable '" + name + "' since it already exists.";
-            throw std::runtime_error(error_message);
-        }
+        checkMatrixVariableName(name);
 
         MatrixX matrix(rows, cols);
         for (int row = 0; row < matrix.rows(); row++)
@@ -61,37 +60,164 @@ namespace cvx
         return matrix;
     }
 
-    void OptimizationProblem::addConstraint(const Constraint &constraint)
+    MatrixX OptimizationProblem::addVariable(const std::string &name,
+                                             const Eigen::SparseMatrix<double> &pattern)
+    {
+        checkMatrixVariableName(name);
+
+        MatrixX matrix = MatrixX::Zero(pattern.rows(), pattern.cols());
+        for (int k = 0; k < pattern.outerSize(); k++)
+        {
+            for (Eigen::SparseMatrix<double>::InnerIterator it(pattern, k); it; ++it)
+            {
+                matrix(it.row(), it.col()) = Variable(name, it.row(), it.col());
+            }
+        }
+        matrix_variables.emplace(name, matrix);
+
+        return matrix;
+    }
+
+    MatrixX OptimizationProblem::addSymmetricVariable(const std::string &name,
+                                                      size_t size)
+    {
+        checkMatrixVariableName(name);
+
+        MatrixX matrix(size, size);
+        for (int col = 0; col < matrix.cols(); col++)
+        {
+            for (int row = 0; row <= col; row++)
+            {
+                // Mirrored entries share the variable of the upper triangular part
+                matrix(row, col) = Variable(name, row, col);
+                matrix(col, row) = matrix(row, col);
+            }
+        }
+        matrix_variables.emplace(name, matrix);
+
+        return matrix;
+    }
+
+    MatrixX OptimizationProblem::addDiagonalVariable(const std::string &name,
+                                                     size_t size)
     {
+        Eigen::SparseMatrix<double> pattern(size, size);
+        pattern.setIdentity();
+
+        return addVariable(name, pattern);
+    }
+
+    void OptimizationProblem::checkMatrixVariableName(const std::string &name) const
+    {
+        if (matrix_variables.find(name) != matrix_variables.end())
+        {
+            const std::string error_message = "Could not add matrix variable '" + name + "' since it already exists.";
+            throw std::runtime_error(error_message);
+        }
+    }
+
+    ConstraintHandle OptimizationProblem::addConstraint(const Constraint &constraint)
+    {
+        ConstraintHandle handle;
+        handle.source = std::make_shared<ConstraintSource>();
+
+        addConstraint(constraint, handle.source);
+
+        return handle;
+    }
+
+    ConstraintHandle OptimizationProblem::addConstraint(const std::vector<Constraint> &constraints)
+    {
+        ConstraintHandle handle;
+        handle.source = std::make_shared<ConstraintSource>();
+
+        for (const Constraint &constraint : constraints)
+        {
+            addConstraint(constraint, handle.source);
+        }
+
+        return handle;
+    }
+
+    void OptimizationProblem::addConstraint(const Constraint &constraint,
+                                            const std::shared_ptr<ConstraintSource> &source)
+    {
+        source->num_constraints++;
+
         if (constraint.getType() == Constraint::Type::Equality)
         {
             this->equality_constraints.push_back(std::get<Constraint::Type::Equality>(constraint.data));
+            this->equality_constraints.back().source = source;
         }
         else if (constraint.getType() == Constraint::Type::Positive)
         {
             this->positive_constraints.push_back(std::get<Constraint::Type::Positive>(constraint.data));
+            this->positive_constraints.back().source = source;
         }
         else if (constraint.getType() == Constraint::Type::Box)
         {
             this->box_constraints.push_back(std::get<Constraint::Type::Box>(constraint.data));
+            this->box_constraints.back().source = source;
         }
         else if (constraint.getType() == Constraint::Type::SecondOrderCone)
         {
             this->second_order_cone_constraints.push_back(std::get<Constraint::Type::SecondOrderCone>(constraint.data));
+            this->second_order_cone_constraints.back().source = source;
+        }
+        else if (constraint.getType() == Constraint::Type::RotatedSecondOrderCone)
+        {
+            this->rotated_second_order_cone_constraints.push_back(std::get<Constraint::Type::RotatedSecondOrderCone>(constraint.data));
+            this->rotated_second_order_cone_constraints.back().source = source;
         }
     }
 
-    void OptimizationProblem::addConstraint(const std::vector<Constraint> &constraints)
+    void OptimizationProblem::addCostTerm(const Scalar &term)
     {
-        for (const Constraint &constraint : constraints)
+        this->costFunction += term;
+        this->cost_revision++;
+    }
+
+    void OptimizationProblem::addCostSlotTerm(const std::string &slot, const Scalar &term)
+    {
+        auto found = cost_slots.find(slot);
+
+        if (found == cost_slots.end())
         {
-            addConstraint(constraint);
+            const double weight = cost_slots.empty() ? 1. : 0.;
+            found = cost_slots.emplace(slot, CostSlot{Scalar(), weight}).first;
         }
+
+        found->second.cost += term;
+        this->cost_revision++;
     }
 
-    void OptimizationProblem::addCostTerm(const Scalar &term)
+    void OptimizationProblem::activateCostSlot(const std::string &slot)
     {
-        this->costFunction += term;
+        if (cost_slots.find(slot) == cost_slots.end())
+        {
+            const std::string error_message = "Could not find cost slot '" + slot + "'. Make sure it has been created first.";
+            throw std::runtime_error(error_message);
+        }
+
+        for (auto &[name, cost_slot] : cost_slots)
+        {
+            cost_slot.weight = name == slot ? 1. : 0.;
+        }
+    }
+
+    void OptimizationProblem::setCostSlotWeight(const std::string &slot, double weight)
+    {
+        auto found = cost_slots.find(slot);
+
+        if (found != cost_slots.end())
+        {
+            found->second.weight = weight;
+        }
+        else
+        {
+            const std::string error_message = "Could not find cost slot '" + slot + "'. Make sure it has been created first.";
+            throw std::runtime_error(error_message);
+        }
     }
 
     void OptimizationProblem::getVariableValue(const std::string &name, double &var)
@@ -184,9 +310,103 @@ namespace cvx
         }
     }
 
+    void OptimizationProblem::getSlackValue(const ConstraintHandle &handle, Eigen::VectorXd &slacks) const
+    {
+        // Visit the constraints of the handle, the slacks are only evaluated if needed
+        auto visit = [&](auto &&add) {
+            for (const EqualityConstraint &c : equality_constraints)
+            {
+                if (c.source == handle.source)
+                {
+                    add([&]() { return c.affine.evaluate(); });
+                }
+            }
+            for (const PositiveConstraint &c : positive_constraints)
+            {
+                if (c.source == handle.source)
+                {
+                    add([&]() {
+                        double value = c.affine.evaluate();
+                        for (const PiecewiseLinear &piecewise_linear : c.piecewise_linear)
+                        {
+                            value -= piecewise_linear.evaluate();
+                        }
+                        return value;
+                    });
+                }
+            }
+            for (const BoxConstraint &c : box_constraints)
+            {
+                if (c.source == handle.source)
+                {
+                    add([&]() {
+                        const double middle = c.middle.evaluate();
+                        return std::min(middle - c.lower.evaluate(), c.upper.evaluate() - middle);
+                    });
+                }
+            }
+            for (const SecondOrderConeConstraint &c : second_order_cone_constraints)
+            {
+                if (c.source == handle.source)
+                {
+                    add([&]() {
+                        double squared_norm = 0.;
+                        for (const Affine &affine : c.norm)
+                        {
+                            squared_norm += std::pow(affine.evaluate(), 2);
+                        }
+                        return c.affine.evaluate() - std::sqrt(squared_norm);
+                    });
+                }
+            }
+            for (const RotatedSecondOrderConeConstraint &c : rotated_second_order_cone_constraints)
+            {
+                if (c.source == handle.source)
+                {
+                    // The equivalent cone ||(2 * norm, first - second)|| <= first + second
+                    add([&]() {
+                        const double first = c.first_factor.evaluate();
+                        const double second = c.second_factor.evaluate();
+                        double squared_norm = std::pow(first - second, 2);
+                        for (const Affine &affine : c.norm)
+                        {
+                            squared_norm += 4. * std::pow(affine.evaluate(), 2);
+                        }
+                        return first + second - std::sqrt(squared_norm);
+                    });
+                }
+            }
+        };
+
+        size_t num_constraints = 0;
+        visit([&](auto &&) { num_constraints++; });
+
+        if (num_constraints == 0)
+        {
+            throw std::runtime_error("The constraint handle does not belong to this problem.");
+        }
+
+        if (size_t(slacks.size()) != num_constraints)
+        {
+            slacks.resize(num_constraints);
+        }
+        size_t k = 0;
+        visit([&](auto &&slack) { slacks(k++) = slack(); });
+    }
+
     double OptimizationProblem::getOptimalValue() const
     {
-        return eval(costFunction);
+        double value = eval(costFunction);
+
+        for (const auto &[name, cost_slot] : cost_slots)
+        {
+            if (cost_slot.weight != 0.)
+            {
+                value += cost_slot.weight * eval(cost_slot.cost);
+            }
+        }
+
+        return value;
     }
 
     std::ostream &operator<<(std::ostream &os, const OptimizationProblem &op)
@@ -194,6 +414,12 @@ namespace cvx
         os << "Minimize\n";
         os << op.costFunction << "\n\n";
 
+        for (const auto &[name, cost_slot] : op.cost_slots)
+        {
+            os << "Cost slot '" << name << "' with weight " << cost_slot.weight << ":\n";
+            os << cost_slot.cost << "\n\n";
+        }
+
         os << "Subject to\n\n";
 
         os << "Equality Constraints:\n";
@@ -220,6 +446,12 @@ namespace cvx
             os << c << "\n\n";
         }
         os << "\n";
+        os << "Rotated Second Order Cone Constraints:\n";
+        for (const internal::RotatedSecondOrderConeConstraint &c : op.rotated_second_order_cone_constraints)
+        {
+            os << c << "\n\n";
+        }
+        os << "\n";
 
         return os;
     }
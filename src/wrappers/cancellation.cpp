@@ -0,0 +1,38 @@
+#include "wrappers/cancellation.hpp"
+
+#include <stdexcept>
+
+namespace cvx
+{
+
+    CancellationToken::CancellationToken()
+        : cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+    CancellationToken::CancellationToken(std::shared_ptr<std::atomic<bool>> cancelled)
+        : cancelled(std::move(cancelled)) {}
+
+    CancellationToken CancellationToken::none()
+    {
+        return CancellationToken(nullptr);
+    }
+
+    void CancellationToken::cancel()
+    {
+        if (not cancelled)
+        {
+            throw std::runtime_error("This token can not be cancelled.");
+        }
+        cancelled->store(true);
+    }
+
+    bool CancellationToken::isCancelled() const
+    {
+        return cancelled and cancelled->load();
+    }
+
+    bool CancellationToken::canBeCancelled() const
+    {
+        return cancelled != nullptr;
+    }
+
+} // namespace cvx
@@ -3,18 +3,45 @@
 namespace cvx::ecos
 {
 
-    ECOSSolver::ECOSSolver(OptimizationProblem &problem) : SOCPWrapperBase(problem)
+    ECOSSolver::ECOSSolver(OptimizationProblem &problem, bool presolve)
+        : SOCPWrapperBase(problem, presolve)
     {
+        setup();
+    }
+
+    void ECOSSolver::setup()
+    {
+        // The signs for A and G must be flipped because they are negative in the ECOS interface
+        G_map = internal::AffineParameterMap(G_params.values(), -1.);
+        A_map = internal::AffineParameterMap(A_params.values(), -1.);
+        c_map = internal::AffineParameterMap(c_params);
+        h_map = internal::AffineParameterMap(h_params);
+        b_map = internal::AffineParameterMap(b_params);
+
+        // ECOS keeps pointers to the data, which is updated in place
+        G.resize(G_params.nonZeros());
+        A.resize(A_params.nonZeros());
+        c.resize(c_params.size());
+        h.resize(h_params.size());
+        b.resize(b_params.size());
+        yz.resize(getNumEqualityConstraints() + getNumInequalityConstraints());
         update();
 
+        G_prepared.resize(G.size());
+        A_prepared.resize(A.size());
+        c_prepared.resize(c.size());
+        h_prepared.resize(h.size());
+        b_prepared.resize(b.size());
+        discardPreparedUpdate();
+
         cone_constraint_dimensions = soc_dims.cast<idxint>();
-        G_row_ind = Eigen::Map<Eigen::VectorXi>(G_params.innerIndexPtr(), G_params.nonZeros()).cast<idxint>();
-        A_row_ind = Eigen::Map<Eigen::VectorXi>(A_params.innerIndexPtr(), A_params.nonZeros()).cast<idxint>();
-        G_col_ind = Eigen::Map<Eigen::VectorXi>(G_params.outerIndexPtr(), G_params.outerSize() + 1).cast<idxint>();
-        A_col_ind = Eigen::Map<Eigen::VectorXi>(A_params.outerIndexPtr(), A_params.outerSize() + 1).cast<idxint>();
+        G_row_ind = Eigen::Map<const Eigen::VectorXi>(G_params.innerIndexPtr(), G_params.nonZeros()).cast<idxint>();
+        A_row_ind = Eigen::Map<const Eigen::VectorXi>(A_params.innerIndexPtr(), A_params.nonZeros()).cast<idxint>();
+        G_col_ind = Eigen::Map<const Eigen::VectorXi>(G_params.outerIndexPtr(), G_params.cols() + 1).cast<idxint>();
+        A_col_ind = Eigen::Map<const Eigen::VectorXi>(A_params.outerIndexPtr(), A_params.cols() + 1).cast<idxint>();
 
         work = ECOS_setup(
-            getNumVariables(),
+            getNumSolverVariables(),
             getNumInequalityConstraints(),
             getNumEqualityConstraints(),
             getNumPositiveConstraints(),
@@ -38,33 +65,72 @@ namespace cvx::ecos
         }
     }
 
+    void ECOSSolver::rebuildWorkspace()
+    {
+        std::lock_guard<std::mutex> lock(update_mutex);
+
+        // Keep the settings
+        const settings stgs = *work->stgs;
+
+        cleanUp();
+        setup();
+
+        *work->stgs = stgs;
+    }
+
     bool ECOSSolver::solve(bool verbose)
     {
         work->stgs->verbose = verbose;
+        cancelled = false;
 
-        update();
-
-        ECOS_updateData(work,
-                        G.data(),
-                        A.data(),
-                        c.data(),
-                        h.data(),
-                        b.data());
+        {
+            std::lock_guard<std::mutex> lock(update_mutex);
+
+            if (not takePreparedUpdate())
+            {
+                update();
+            }
+
+            ECOS_updateData(work,
+                            G.data(),
+                            A.data(),
+                            c.data(),
+                            h.data(),
+                            b.data());
+        }
 
         exitflag = ECOS_solve(work);
 
-        *solution = std::vector<double>(work->x, work->x + getNumVariables());
+        setSolution(work->x);
+
+        // A and G are negated in the ECOS interface
+        yz << Eigen::Map<Eigen::VectorXd>(work->y, getNumEqualityConstraints()),
+            Eigen::Map<Eigen::VectorXd>(work->z, getNumInequalityConstraints());
+        setDualSolution(yz, -1.);
 
-        if (exitflag == ECOS_SIGINT)
+        return exitflag != ECOS_FATAL and exitflag != ECOS_SIGINT;
+    }
+
+    bool ECOSSolver::solve(const CancellationToken &token, bool verbose)
+    {
+        // ECOS can not be interrupted without a signal, so the token is only checked before the solve
+        if (token.isCancelled())
         {
-            std::exit(130);
+            cancelled = true;
+            exitflag = ECOS_SIGINT;
+            return false;
         }
 
-        return exitflag != ECOS_FATAL;
+        return solve(verbose);
     }
 
     std::string ECOSSolver::getResultString() const
     {
+        if (cancelled)
+        {
+            return "Solve cancelled.";
+        }
+
         switch (exitflag)
         {
         case ECOS_UNSOLVED:
@@ -115,17 +181,39 @@ namespace cvx::ecos
 
     void ECOSSolver::update()
     {
-        // The signs for A and G must be flipped because they are negative in the ECOS interface
-        G = -eval(Eigen::Map<VectorXp>(G_params.valuePtr(), G_params.nonZeros()));
-        A = -eval(Eigen::Map<VectorXp>(A_params.valuePtr(), A_params.nonZeros()));
-        c = eval(c_params);
-        h = eval(h_params);
-        b = eval(b_params);
+        G_map.evaluate(G);
+        A_map.evaluate(A);
+        c_map.evaluate(c);
+        h_map.evaluate(h);
+        b_map.evaluate(b);
+
+        relaxDisabledRows(G, h, A, b);
+    }
+
+    void ECOSSolver::swapUpdateBuffers()
+    {
+        G.swap(G_prepared);
+        A.swap(A_prepared);
+        c.swap(c_prepared);
+        h.swap(h_prepared);
+        b.swap(b_prepared);
+    }
+
+    void ECOSSolver::evaluatePreparedUpdate()
+    {
+        // A running solve only refers to the memory of the current buffer, which is not written here
+        swapUpdateBuffers();
+        update();
+        swapUpdateBuffers();
     }
 
     void ECOSSolver::cleanUp()
     {
-        ECOS_cleanup(work, 0);
+        if (work != nullptr)
+        {
+            ECOS_cleanup(work, 0);
+            work = nullptr;
+        }
     }
 
     ECOSSolver::~ECOSSolver()
@@ -0,0 +1,202 @@
+#include "wrappers/osqpBatchSolver.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+namespace cvx::osqp
+{
+
+    BatchSolver::BatchSolver(OptimizationProblem &problem, const std::vector<double *> &parameters, bool presolve)
+        : solver(problem, presolve), parameters(parameters) {}
+
+    OSQPSolver &BatchSolver::getSolver()
+    {
+        return solver;
+    }
+
+    void BatchSolver::solve(const Eigen::MatrixXd &parameter_values, size_t num_threads)
+    {
+        if (size_t(parameter_values.rows()) != parameters.size())
+        {
+            throw std::runtime_error("The number of parameter values does not match the number of parameters.");
+        }
+
+        const size_t num_instances = parameter_values.cols();
+        solutions.resize(num_instances, solver.getNumVariables());
+        status.resize(num_instances);
+        iterations.resize(num_instances);
+
+        if (num_threads == 0)
+        {
+            num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        num_threads = std::min(num_threads, num_instances);
+
+        // Clone the workspace of the solver with the current problem data
+        {
+            std::lock_guard<std::mutex> lock(solver.update_mutex);
+            solver.update(true);
+        }
+        const internal::AffineParameterMap fixed_map(solver.presolve ? solver.presolve->getFixedValues()
+                                                                     : std::vector<internal::Parameter>());
+        std::vector<Worker> workers(num_threads);
+        for (Worker &worker : workers)
+        {
+            if (osqp_setup(&worker.workspace, &solver.data, solver.workspace->settings) != 0)
+            {
+                for (Worker &w : workers)
+                {
+                    osqp_cleanup(w.workspace);
+                }
+                throw std::runtime_error("OSQP failed to set up the problem.");
+            }
+            worker.P_values = solver.P_values;
+            worker.A_values = solver.A_values;
+            OSQPSolver::setupMatrixUpdate(solver.P_map, worker.P_values, worker.P_update);
+            OSQPSolver::setupMatrixUpdate(solver.A_map, worker.A_values, worker.A_update);
+            worker.solution.resize(solver.getNumVariables());
+
+            // The workers are not moved anymore, so the maps can refer to their parameter values
+            worker.parameter_values.resize(parameters.size());
+            std::vector<const double *> values(parameters.size());
+            for (size_t i = 0; i < parameters.size(); i++)
+            {
+                values[i] = &worker.parameter_values[i];
+            }
+            worker.P_map = solver.P_map.rebind(parameters, values);
+            worker.A_map = solver.A_map.rebind(parameters, values);
+            worker.q_map = solver.q_map.rebind(parameters, values);
+            worker.l_map = solver.l_map.rebind(parameters, values);
+            worker.u_map = solver.u_map.rebind(parameters, values);
+            worker.fixed_map = fixed_map.rebind(parameters, values);
+            worker.q.resize(solver.q.size());
+            worker.l.resize(solver.l.size());
+            worker.u.resize(solver.u.size());
+            worker.fixed_values.resize(fixed_map.size());
+        }
+
+        // Every worker takes the next instance until all have been solved
+        std::atomic<size_t> next_instance = 0;
+        std::vector<std::exception_ptr> errors(num_threads);
+        auto work = [&](size_t k) {
+            try
+            {
+                for (size_t instance = next_instance++; instance < num_instances; instance = next_instance++)
+                {
+                    solveInstance(workers[k], parameter_values, instance);
+                }
+            }
+            catch (...)
+            {
+                errors[k] = std::current_exception();
+                next_instance = num_instances;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t k = 1; k < num_threads; k++)
+        {
+            threads.emplace_back(work, k);
+        }
+        if (num_threads > 0)
+        {
+            work(0);
+        }
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+
+        for (Worker &worker : workers)
+        {
+            osqp_cleanup(worker.workspace);
+        }
+
+        for (const std::exception_ptr &error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    void BatchSolver::solveInstance(Worker &worker, const Eigen::MatrixXd &parameter_values, size_t instance)
+    {
+        for (size_t i = 0; i < parameters.size(); i++)
+        {
+            worker.parameter_values[i] = parameter_values(i, instance);
+        }
+
+        // The constant entries of P and A have been copied from the solver
+        worker.P_map.updateDynamic(worker.P_values);
+        worker.A_map.updateDynamic(worker.A_values);
+        worker.q_map.evaluate(worker.q);
+        worker.l_map.evaluate(worker.l);
+        worker.u_map.evaluate(worker.u);
+        solver.relaxDisabledRows(worker.l, worker.u);
+
+        // Only update P and A if they have changed since the last instance of this worker
+        const c_int num_P_changed = OSQPSolver::collectChanges(worker.P_values, worker.P_update);
+        if (num_P_changed > 0)
+        {
+            osqp_update_P(worker.workspace, worker.P_update.changed_values.data(), worker.P_update.changed_idx.data(), num_P_changed);
+        }
+        const c_int num_A_changed = OSQPSolver::collectChanges(worker.A_values, worker.A_update);
+        if (num_A_changed > 0)
+        {
+            osqp_update_A(worker.workspace, worker.A_update.changed_values.data(), worker.A_update.changed_idx.data(), num_A_changed);
+        }
+        osqp_update_lin_cost(worker.workspace, worker.q.data());
+        osqp_update_bounds(worker.workspace, worker.l.data(), worker.u.data());
+
+        osqp_solve(worker.workspace);
+        status(instance) = worker.workspace->info->status_val;
+        iterations(instance) = worker.workspace->info->iter;
+
+        if (solver.presolve)
+        {
+            // The values of fixed variables may depend on the parameters
+            worker.fixed_map.evaluate(worker.fixed_values);
+            solver.presolve->postsolvePrimal(worker.workspace->solution->x, worker.fixed_values, worker.solution);
+        }
+        else
+        {
+            std::copy_n(worker.workspace->solution->x, worker.solution.size(), worker.solution.begin());
+        }
+        solutions.row(instance) = Eigen::Map<const Eigen::RowVectorXd>(worker.solution.data(), worker.solution.size());
+    }
+
+    size_t BatchSolver::getNumInstances() const
+    {
+        return solutions.rows();
+    }
+
+    const Eigen::MatrixXd &BatchSolver::getSolutions() const
+    {
+        return solutions;
+    }
+
+    Eigen::VectorXd BatchSolver::getValues(const Scalar &variable) const
+    {
+        size_t index;
+        if (not solver.getGuessIndex(variable, index))
+        {
+            throw std::runtime_error("Only single variables of the problem can be evaluated.");
+        }
+        return solutions.col(index);
+    }
+
+    const Eigen::Matrix<c_int, Eigen::Dynamic, 1> &BatchSolver::getStatus() const
+    {
+        return status;
+    }
+
+    const Eigen::Matrix<c_int, Eigen::Dynamic, 1> &BatchSolver::getIterations() const
+    {
+        return iterations;
+    }
+
+} // namespace cvx::osqp
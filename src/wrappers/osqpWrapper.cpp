@@ -1,31 +1,61 @@
 #include "wrappers/osqpWrapper.hpp"
 
+#include <algorithm>
+#include <chrono>
+
 namespace cvx::osqp
 {
 
-    OSQPSolver::OSQPSolver(OptimizationProblem &problem) : internal::QPWrapperBase(problem)
+    OSQPSolver::OSQPSolver(OptimizationProblem &problem, bool presolve)
+        : internal::QPWrapperBase(problem, presolve)
     {
-        update();
+        osqp_set_default_settings(&settings);
+        settings.verbose = false;
 
-        P_row_ind = Eigen::Map<Eigen::VectorXi>(P.innerIndexPtr(), P.nonZeros()).cast<c_int>();
-        A_row_ind = Eigen::Map<Eigen::VectorXi>(A.innerIndexPtr(), A.nonZeros()).cast<c_int>();
-        P_col_ind = Eigen::Map<Eigen::VectorXi>(P.outerIndexPtr(), P.outerSize() + 1).cast<c_int>();
-        A_col_ind = Eigen::Map<Eigen::VectorXi>(A.outerIndexPtr(), A.outerSize() + 1).cast<c_int>();
+        setup();
+    }
+
+    void OSQPSolver::setup()
+    {
+        P_map = internal::AffineParameterMap(P_params.values());
+        A_map = internal::AffineParameterMap(A_params.values());
+        q_map = internal::AffineParameterMap(q_params);
+        l_map = internal::AffineParameterMap(l_params);
+        u_map = internal::AffineParameterMap(u_params);
+
+        // The data is updated in place, so the arrays are only allocated here
+        P_values.resize(P_params.nonZeros());
+        A_values.resize(A_params.nonZeros());
+        q.resize(q_params.size());
+        l.resize(l_params.size());
+        u.resize(u_params.size());
+        update(true);
+
+        // The constant entries of the second buffer are never evaluated again
+        P_prepared = P_values;
+        A_prepared = A_values;
+        q_prepared = q;
+        l_prepared = l;
+        u_prepared = u;
+        prepared_rows_relaxed = rows_relaxed;
+        discardPreparedUpdate();
+
+        P_row_ind = Eigen::Map<const Eigen::VectorXi>(P_params.innerIndexPtr(), P_params.nonZeros()).cast<c_int>();
+        A_row_ind = Eigen::Map<const Eigen::VectorXi>(A_params.innerIndexPtr(), A_params.nonZeros()).cast<c_int>();
+        P_col_ind = Eigen::Map<const Eigen::VectorXi>(P_params.outerIndexPtr(), P_params.cols() + 1).cast<c_int>();
+        A_col_ind = Eigen::Map<const Eigen::VectorXi>(A_params.outerIndexPtr(), A_params.cols() + 1).cast<c_int>();
 
         // Populate data
-        data.n = getNumVariables();
+        data.n = getNumSolverVariables();
         data.m = getNumInequalityConstraints();
-        data.P = csc_matrix(getNumVariables(), getNumVariables(), P.nonZeros(),
-                            P.valuePtr(), P_row_ind.data(), P_col_ind.data());
+        data.P = csc_matrix(getNumSolverVariables(), getNumSolverVariables(), P_values.size(),
+                            P_values.data(), P_row_ind.data(), P_col_ind.data());
         data.q = q.data();
-        data.A = csc_matrix(getNumInequalityConstraints(), getNumVariables(), A.nonZeros(),
-                            A.valuePtr(), A_row_ind.data(), A_col_ind.data());
+        data.A = csc_matrix(getNumInequalityConstraints(), getNumSolverVariables(), A_values.size(),
+                            A_values.data(), A_row_ind.data(), A_col_ind.data());
         data.l = l.data();
         data.u = u.data();
 
-        osqp_set_default_settings(&settings);
-        settings.verbose = false;
-
         exitflag = osqp_setup(&workspace, &data, &settings);
 
         if (exitflag != 0)
@@ -33,38 +63,229 @@ namespace cvx::osqp
             cleanUp();
             throw std::runtime_error("OSQP failed to set up the problem.");
         }
+
+        setupMatrixUpdate(P_map, P_values, P_update);
+        setupMatrixUpdate(A_map, A_values, A_update);
     }
 
-    void OSQPSolver::update()
+    void OSQPSolver::setupMatrixUpdate(const internal::AffineParameterMap &map,
+                                       const Eigen::Matrix<c_float, Eigen::Dynamic, 1> &values,
+                                       MatrixUpdate &matrix_update)
     {
-        P = eval(P_params);
-        q = eval(q_params);
-        A = eval(A_params);
-        l = eval(l_params);
-        u = eval(u_params);
+        const std::vector<size_t> dynamic_indices = map.getDynamicIndices();
+
+        matrix_update.dynamic_idx.resize(dynamic_indices.size());
+        matrix_update.workspace_values.resize(dynamic_indices.size());
+        for (size_t i = 0; i < dynamic_indices.size(); i++)
+        {
+            matrix_update.dynamic_idx(i) = dynamic_indices[i];
+            matrix_update.workspace_values(i) = values(dynamic_indices[i]);
+        }
+        matrix_update.changed_idx.resize(dynamic_indices.size());
+        matrix_update.changed_values.resize(dynamic_indices.size());
     }
 
-    bool OSQPSolver::solve(bool verbose)
+    c_int OSQPSolver::collectChanges(const Eigen::Matrix<c_float, Eigen::Dynamic, 1> &values,
+                                     MatrixUpdate &matrix_update)
     {
-        osqp_update_verbose(workspace, verbose);
+        c_int num_changed = 0;
+        for (Eigen::Index i = 0; i < matrix_update.dynamic_idx.size(); i++)
+        {
+            const c_int k = matrix_update.dynamic_idx(i);
+            if (values(k) != matrix_update.workspace_values(i))
+            {
+                matrix_update.workspace_values(i) = values(k);
+                matrix_update.changed_idx(num_changed) = k;
+                matrix_update.changed_values(num_changed) = values(k);
+                num_changed++;
+            }
+        }
+        return num_changed;
+    }
+
+    void OSQPSolver::rebuildWorkspace()
+    {
+        std::lock_guard<std::mutex> lock(update_mutex);
+
+        // Keep the settings and the last solution as a warm start
+        settings = *workspace->settings;
+        const Eigen::Matrix<c_float, Eigen::Dynamic, 1> x_prev = Eigen::Map<Eigen::Matrix<c_float, Eigen::Dynamic, 1>>(workspace->solution->x, workspace->data->n);
+        const Eigen::Matrix<c_float, Eigen::Dynamic, 1> y_prev = Eigen::Map<Eigen::Matrix<c_float, Eigen::Dynamic, 1>>(workspace->solution->y, workspace->data->m);
+        const bool was_solved = workspace->info->status_val != OSQP_UNSOLVED;
+
+        cleanUp();
+        setup();
+
+        if (was_solved)
+        {
+            Eigen::Matrix<c_float, Eigen::Dynamic, 1> x_warm = Eigen::Matrix<c_float, Eigen::Dynamic, 1>::Zero(getNumSolverVariables());
+            Eigen::Matrix<c_float, Eigen::Dynamic, 1> y_warm = Eigen::Matrix<c_float, Eigen::Dynamic, 1>::Zero(getNumInequalityConstraints());
+            x_warm.head(x_prev.size()) = x_prev;
+            y_warm.head(y_prev.size()) = y_prev;
+            osqp_warm_start(workspace, x_warm.data(), y_warm.data());
+        }
+    }
+
+    void OSQPSolver::update(bool all_entries)
+    {
+        if (all_entries)
+        {
+            P_map.evaluate(P_values);
+            A_map.evaluate(A_values);
+            q_map.evaluate(q);
+        }
+        else
+        {
+            P_map.updateDynamic(P_values);
+            A_map.updateDynamic(A_values);
+            q_map.updateDynamic(q);
+        }
+
+        // Restore the constant bounds of rows that have been relaxed before
+        if (all_entries or rows_relaxed)
+        {
+            l_map.evaluate(l);
+            u_map.evaluate(u);
+        }
+        else
+        {
+            l_map.updateDynamic(l);
+            u_map.updateDynamic(u);
+        }
+
+        rows_relaxed = relaxDisabledRows(l, u);
+    }
 
+    void OSQPSolver::swapUpdateBuffers()
+    {
+        P_values.swap(P_prepared);
+        A_values.swap(A_prepared);
+        q.swap(q_prepared);
+        l.swap(l_prepared);
+        u.swap(u_prepared);
+        std::swap(rows_relaxed, prepared_rows_relaxed);
+    }
+
+    void OSQPSolver::evaluatePreparedUpdate()
+    {
+        // The workspace holds a copy of the current buffer, so the second buffer can be evaluated in its place
+        swapUpdateBuffers();
         update();
+        swapUpdateBuffers();
+    }
 
-        osqp_update_P(workspace, P.valuePtr(), OSQP_NULL, 0);
-        osqp_update_A(workspace, A.valuePtr(), OSQP_NULL, 0);
-        osqp_update_lin_cost(workspace, q.data());
-        osqp_update_bounds(workspace, l.data(), u.data());
+    bool OSQPSolver::solve(bool verbose)
+    {
+        osqp_update_verbose(workspace, verbose);
+        updateWorkspace();
 
+        cancelled = false;
         exitflag = osqp_solve(workspace);
 
-        *solution = std::vector<double>(workspace->solution->x,
-                                        workspace->solution->x + getNumVariables());
+        setSolution(workspace->solution->x);
+        setDualSolution(Eigen::Map<Eigen::VectorXd>(workspace->solution->y, getNumInequalityConstraints()), 1.);
 
         return exitflag == 0;
     }
 
+    bool OSQPSolver::solve(const CancellationToken &token, bool verbose)
+    {
+        cancelled = token.isCancelled();
+        if (cancelled)
+        {
+            exitflag = OSQP_SIGINT;
+            return false;
+        }
+        if (not token.canBeCancelled())
+        {
+            return solve(verbose);
+        }
+
+        osqp_update_verbose(workspace, verbose);
+        updateWorkspace();
+
+        // Run the iterations in chunks that continue from the last iterate and check the token in between
+        OSQPSettings &current = *workspace->settings;
+        const c_int max_iter = current.max_iter;
+        const c_int warm_start = current.warm_start;
+        const c_float time_limit = current.time_limit;
+        const c_int chunk = current.check_termination > 0 ? current.check_termination : cancel_check_interval;
+        const auto start = std::chrono::steady_clock::now();
+
+        c_int iterations = 0;
+        while (true)
+        {
+            osqp_update_max_iter(workspace, std::min(chunk, max_iter - iterations));
+            exitflag = osqp_solve(workspace);
+            iterations += workspace->info->iter;
+            osqp_update_warm_start(workspace, 1);
+
+            if (exitflag != 0 or workspace->info->status_val != OSQP_MAX_ITER_REACHED or iterations >= max_iter)
+            {
+                break;
+            }
+            if (token.isCancelled())
+            {
+                cancelled = true;
+                break;
+            }
+            if (time_limit > 0.)
+            {
+                const c_float elapsed = std::chrono::duration<c_float>(std::chrono::steady_clock::now() - start).count();
+                if (elapsed >= time_limit)
+                {
+                    break;
+                }
+                osqp_update_time_limit(workspace, time_limit - elapsed);
+            }
+        }
+
+        osqp_update_max_iter(workspace, max_iter);
+        osqp_update_warm_start(workspace, warm_start);
+        osqp_update_time_limit(workspace, time_limit);
+        workspace->info->iter = iterations;
+
+        setSolution(workspace->solution->x);
+        setDualSolution(Eigen::Map<Eigen::VectorXd>(workspace->solution->y, getNumInequalityConstraints()), 1.);
+
+        if (cancelled)
+        {
+            exitflag = OSQP_SIGINT;
+            return false;
+        }
+        return exitflag == 0;
+    }
+
+    void OSQPSolver::updateWorkspace()
+    {
+        std::lock_guard<std::mutex> lock(update_mutex);
+
+        if (not takePreparedUpdate())
+        {
+            update();
+        }
+
+        // Updating P or A triggers a new factorization, so skip them if nothing has changed
+        const c_int num_P_changed = collectChanges(P_values, P_update);
+        if (num_P_changed > 0)
+        {
+            osqp_update_P(workspace, P_update.changed_values.data(), P_update.changed_idx.data(), num_P_changed);
+        }
+        const c_int num_A_changed = collectChanges(A_values, A_update);
+        if (num_A_changed > 0)
+        {
+            osqp_update_A(workspace, A_update.changed_values.data(), A_update.changed_idx.data(), num_A_changed);
+        }
+        osqp_update_lin_cost(workspace, q.data());
+        osqp_update_bounds(workspace, l.data(), u.data());
+    }
+
     std::string OSQPSolver::getResultString() const
     {
+        if (cancelled)
+        {
+            return "Solve cancelled.";
+        }
         return workspace->info->status;
     }
 
@@ -153,6 +374,62 @@ namespace cvx::osqp
         osqp_update_warm_start(workspace, c_int(warm_start));
     }
 
+    void OSQPSolver::warmStart(const std::string &name, double value)
+    {
+        Scalar variable;
+        problem.getVariable(name, variable);
+        setPrimalGuess(MatrixX::Constant(1, 1, variable), Eigen::MatrixXd::Constant(1, 1, value));
+
+        const Eigen::VectorXd x = getSolverPrimalGuess();
+        osqp_warm_start_x(workspace, x.data());
+    }
+
+    void OSQPSolver::warmStart(const std::string &name, const Eigen::VectorXd &values)
+    {
+        VectorX variable;
+        problem.getVariable(name, variable);
+        setPrimalGuess(variable, values);
+
+        const Eigen::VectorXd x = getSolverPrimalGuess();
+        osqp_warm_start_x(workspace, x.data());
+    }
+
+    void OSQPSolver::warmStart(const std::string &name, const Eigen::MatrixXd &values)
+    {
+        MatrixX variable;
+        problem.getVariable(name, variable);
+        setPrimalGuess(variable, values);
+
+        const Eigen::VectorXd x = getSolverPrimalGuess();
+        osqp_warm_start_x(workspace, x.data());
+    }
+
+    void OSQPSolver::warmStart(const ConstraintHandle &handle, const Eigen::VectorXd &duals)
+    {
+        setDualGuess(handle, duals);
+
+        const Eigen::VectorXd y = getSolverDualGuess();
+        osqp_warm_start_y(workspace, y.data());
+    }
+
+    void OSQPSolver::shiftWarmStart(const std::string &name)
+    {
+        MatrixX variable;
+        problem.getVariable(name, variable);
+        shiftPrimalGuess(variable);
+
+        const Eigen::VectorXd x = getSolverPrimalGuess();
+        osqp_warm_start_x(workspace, x.data());
+    }
+
+    void OSQPSolver::shiftWarmStart(const ConstraintHandle &handle, size_t num_stages)
+    {
+        shiftDualGuess(handle, num_stages);
+
+        const Eigen::VectorXd y = getSolverDualGuess();
+        osqp_warm_start_y(workspace, y.data());
+    }
+
     void OSQPSolver::printSummary() const
     {
         print_summary(workspace);
@@ -161,11 +438,14 @@ namespace cvx::osqp
     void OSQPSolver::cleanUp()
     {
         osqp_cleanup(workspace);
+        workspace = nullptr;
 
         if (data.A)
             c_free(data.A);
         if (data.P)
             c_free(data.P);
+        data.A = nullptr;
+        data.P = nullptr;
     }
 
     OSQPSolver::~OSQPSolver()
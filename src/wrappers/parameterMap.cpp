@@ -0,0 +1,292 @@
+#include "wrappers/parameterMap.hpp"
+
+#include <cassert>
+
+namespace cvx::internal
+{
+
+    AffineParameterMap::AffineParameterMap(const std::vector<Parameter> &params, double scale)
+    {
+        build(params.data(), params.size(), scale);
+    }
+
+    AffineParameterMap::AffineParameterMap(const Eigen::Matrix<Parameter, Eigen::Dynamic, 1> &params, double scale)
+    {
+        build(params.data(), params.size(), scale);
+    }
+
+    size_t AffineParameterMap::size() const
+    {
+        return static_values.size();
+    }
+
+    size_t AffineParameterMap::getNumParameters() const
+    {
+        return parameters.size();
+    }
+
+    size_t AffineParameterMap::getNumNonaffine() const
+    {
+        return nonaffine_params.size();
+    }
+
+    std::vector<size_t> AffineParameterMap::getDynamicIndices() const
+    {
+        std::vector<size_t> indices;
+        indices.reserve(dynamic_values.size());
+        for (const Run &run : dynamic_runs)
+        {
+            for (size_t i = run.start; i < run.start + run.size; i++)
+            {
+                indices.push_back(i);
+            }
+        }
+        return indices;
+    }
+
+    void AffineParameterMap::build(const Parameter *params, size_t size, double scale)
+    {
+        nonaffine_scale = scale;
+        // Pointer sources are identified by their pointer since several sources can share it
+        std::unordered_map<const void *, int> parameter_indices;
+        std::vector<Eigen::Triplet<double>> triplets;
+        std::vector<double> dynamic_offsets;
+        static_values.setZero(size);
+
+        AffineTerms terms;
+        for (size_t i = 0; i < size; i++)
+        {
+            terms.offset = 0.;
+            terms.coefficients.clear();
+
+            const bool is_affine = addTerms(params[i].source, scale, terms);
+            if (is_affine and terms.coefficients.empty())
+            {
+                static_values(i) = terms.offset;
+                continue;
+            }
+
+            // Extend the last run or start a new one
+            const size_t position = dynamic_offsets.size();
+            if (not dynamic_runs.empty() and dynamic_runs.back().start + dynamic_runs.back().size == i)
+            {
+                dynamic_runs.back().size++;
+            }
+            else
+            {
+                dynamic_runs.push_back({i, 1});
+            }
+
+            if (not is_affine)
+            {
+                nonaffine_positions.push_back(position);
+                nonaffine_params.push_back(params[i]);
+                dynamic_offsets.push_back(0.);
+                continue;
+            }
+
+            dynamic_offsets.push_back(terms.offset);
+            for (const auto &[source, coefficient] : terms.coefficients)
+            {
+                const void *key = source->getType() == ParameterType::Pointer
+                                      ? static_cast<const void *>(std::static_pointer_cast<PointerSource>(source)->ptr)
+                                      : source.get();
+                auto found = parameter_indices.emplace(key, parameters.size()).first;
+                if (size_t(found->second) == parameters.size())
+                {
+                    parameters.push_back(source);
+                }
+                triplets.emplace_back(position, found->second, coefficient);
+            }
+        }
+
+        // Duplicate parameters in the same entry are summed up
+        coefficients.resize(dynamic_offsets.size(), parameters.size());
+        coefficients.setFromTriplets(triplets.begin(), triplets.end());
+        offset = Eigen::Map<Eigen::VectorXd>(dynamic_offsets.data(), dynamic_offsets.size());
+
+        parameter_values.resize(parameters.size());
+        dynamic_values.resize(dynamic_offsets.size());
+    }
+
+    bool AffineParameterMap::addTerms(const std::shared_ptr<ParameterSource> &source, double scale, AffineTerms &terms)
+    {
+        switch (source->getType())
+        {
+        case ParameterType::Constant:
+            terms.offset += scale * source->getValue();
+            return true;
+        case ParameterType::Pointer:
+        case ParameterType::Ring:
+            terms.coefficients.emplace_back(source, scale);
+            return true;
+        case ParameterType::Sum:
+            for (const std::shared_ptr<ParameterSource> &term : std::static_pointer_cast<SumSource>(source)->terms)
+            {
+                if (not addTerms(term, scale, terms))
+                {
+                    return false;
+                }
+            }
+            return true;
+        default: // ParameterType::Operation
+            break;
+        }
+
+        const OperationSource &operation = *std::static_pointer_cast<OperationSource>(source);
+        switch (operation.op)
+        {
+        case ParamOpcode::Add:
+            return addTerms(operation.p1, scale, terms) and addTerms(operation.p2, scale, terms);
+        case ParamOpcode::Mul:
+        {
+            // Affine if one of the factors is constant
+            AffineTerms lhs, rhs;
+            if (not addTerms(operation.p1, 1., lhs) or not addTerms(operation.p2, 1., rhs))
+            {
+                return false;
+            }
+            if (not lhs.coefficients.empty() and not rhs.coefficients.empty())
+            {
+                return false;
+            }
+            if (lhs.coefficients.empty())
+            {
+                std::swap(lhs, rhs);
+            }
+            const double factor = scale * rhs.offset;
+            terms.offset += factor * lhs.offset;
+            for (const auto &[parameter, coefficient] : lhs.coefficients)
+            {
+                terms.coefficients.emplace_back(parameter, factor * coefficient);
+            }
+            return true;
+        }
+        case ParamOpcode::Div:
+        {
+            // Affine if the divisor is constant
+            AffineTerms divisor;
+            if (not addTerms(operation.p2, 1., divisor) or not divisor.coefficients.empty())
+            {
+                return false;
+            }
+            return addTerms(operation.p1, scale / divisor.offset, terms);
+        }
+        default: // ParamOpcode::Sqrt, ParamOpcode::Max, ParamOpcode::Min
+            return false;
+        }
+    }
+
+    Eigen::VectorXd AffineParameterMap::evaluate() const
+    {
+        Eigen::VectorXd values(size());
+        evaluate(values);
+        return values;
+    }
+
+    void AffineParameterMap::evaluate(Eigen::Ref<Eigen::VectorXd> values) const
+    {
+        assert(size_t(values.size()) == size());
+
+        values = static_values;
+        updateDynamic(values);
+    }
+
+    void AffineParameterMap::updateDynamic(Eigen::Ref<Eigen::VectorXd> values) const
+    {
+        assert(size_t(values.size()) == size());
+
+        for (size_t i = 0; i < parameters.size(); i++)
+        {
+            parameter_values(i) = parameters[i]->getValue();
+        }
+
+        dynamic_values = offset;
+        dynamic_values.noalias() += coefficients * parameter_values;
+        for (size_t k = 0; k < nonaffine_positions.size(); k++)
+        {
+            dynamic_values(nonaffine_positions[k]) = nonaffine_scale * nonaffine_params[k].getValue();
+        }
+
+        size_t position = 0;
+        for (const Run &run : dynamic_runs)
+        {
+            values.segment(run.start, run.size) = dynamic_values.segment(position, run.size);
+            position += run.size;
+        }
+    }
+
+    AffineParameterMap AffineParameterMap::rebind(const std::vector<double *> &pointers,
+                                                  const std::vector<const double *> &values) const
+    {
+        if (pointers.size() != values.size())
+        {
+            throw std::runtime_error("The number of pointers and values does not match.");
+        }
+
+        std::unordered_map<const double *, const double *> replacements;
+        for (size_t i = 0; i < pointers.size(); i++)
+        {
+            replacements[pointers[i]] = values[i];
+        }
+
+        AffineParameterMap copy = *this;
+        for (std::shared_ptr<ParameterSource> &parameter : copy.parameters)
+        {
+            parameter = rebindSource(parameter, replacements);
+        }
+        for (Parameter &parameter : copy.nonaffine_params)
+        {
+            parameter.source = rebindSource(parameter.source, replacements);
+        }
+        return copy;
+    }
+
+    std::shared_ptr<ParameterSource> AffineParameterMap::rebindSource(const std::shared_ptr<ParameterSource> &source,
+                                                                      const std::unordered_map<const double *, const double *> &pointers)
+    {
+        switch (source->getType())
+        {
+        case ParameterType::Pointer:
+        {
+            auto found = pointers.find(std::static_pointer_cast<PointerSource>(source)->ptr);
+            if (found == pointers.end())
+            {
+                return source;
+            }
+            return std::make_shared<PointerSource>(found->second);
+        }
+        case ParameterType::Operation:
+        {
+            const OperationSource &operation = *std::static_pointer_cast<OperationSource>(source);
+            std::shared_ptr<ParameterSource> p1 = rebindSource(operation.p1, pointers);
+            std::shared_ptr<ParameterSource> p2 = operation.p2 ? rebindSource(operation.p2, pointers) : nullptr;
+            if (p1 == operation.p1 and p2 == operation.p2)
+            {
+                return source;
+            }
+            return std::make_shared<OperationSource>(operation.op, p1, p2);
+        }
+        case ParameterType::Sum:
+        {
+            const SumSource &sum = *std::static_pointer_cast<SumSource>(source);
+            std::vector<std::shared_ptr<ParameterSource>> terms;
+            terms.reserve(sum.terms.size());
+            bool changed = false;
+            for (const std::shared_ptr<ParameterSource> &term : sum.terms)
+            {
+                terms.push_back(rebindSource(term, pointers));
+                changed = changed or terms.back() != term;
+            }
+            if (not changed)
+            {
+                return source;
+            }
+            return std::make_shared<SumSource>(std::move(terms));
+        }
+        default: // ParameterType::Constant, ParameterType::Ring
+            return source;
+        }
+    }
+
+} // namespace cvx::internal
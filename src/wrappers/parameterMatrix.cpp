@@ -0,0 +1,199 @@
+#include "wrappers/parameterMatrix.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+namespace cvx::internal
+{
+
+    void CoefficientList::reserve(size_t size)
+    {
+        triplets.reserve(size);
+        coefficients.reserve(size);
+    }
+
+    void CoefficientList::add(size_t row, size_t col, const Parameter &coefficient)
+    {
+        triplets.push_back({int(row), int(col), int(coefficients.size())});
+        coefficients.push_back(coefficient);
+    }
+
+    void CoefficientList::append(CoefficientList &other, size_t row_offset)
+    {
+        const int first_coefficient = coefficients.size();
+        reserve(size() + other.size());
+        for (const CoefficientTriplet &triplet : other.triplets)
+        {
+            triplets.push_back({triplet.row + int(row_offset), triplet.col, triplet.coefficient + first_coefficient});
+        }
+        std::move(other.coefficients.begin(), other.coefficients.end(), std::back_inserter(coefficients));
+
+        other.triplets.clear();
+        other.coefficients.clear();
+    }
+
+    size_t CoefficientList::size() const
+    {
+        return triplets.size();
+    }
+
+    bool CoefficientList::empty() const
+    {
+        return triplets.empty();
+    }
+
+    ParameterMatrix::ParameterMatrix(size_t rows, size_t cols)
+    {
+        resize(rows, cols);
+    }
+
+    size_t ParameterMatrix::rows() const
+    {
+        return num_rows;
+    }
+
+    size_t ParameterMatrix::cols() const
+    {
+        return num_cols;
+    }
+
+    size_t ParameterMatrix::nonZeros() const
+    {
+        return inner_index.size();
+    }
+
+    void ParameterMatrix::resize(size_t rows, size_t cols)
+    {
+        num_rows = rows;
+        num_cols = cols;
+        outer_index.assign(cols + 1, 0);
+        inner_index.clear();
+        value_params.clear();
+    }
+
+    void ParameterMatrix::conservativeResize(size_t rows, size_t cols)
+    {
+        assert(rows >= num_rows and cols >= num_cols);
+
+        num_rows = rows;
+        num_cols = cols;
+        outer_index.resize(cols + 1, outer_index.back());
+    }
+
+    void ParameterMatrix::setFromCoefficients(CoefficientList &list)
+    {
+        const std::vector<CoefficientTriplet> &triplets = list.triplets;
+
+        // Counting sort of the triplet indices by column
+        std::vector<int> column_start(num_cols + 1, 0);
+        for (const CoefficientTriplet &triplet : triplets)
+        {
+            assert(size_t(triplet.row) < num_rows and size_t(triplet.col) < num_cols);
+            column_start[triplet.col + 1]++;
+        }
+        for (size_t col = 0; col < num_cols; col++)
+        {
+            column_start[col + 1] += column_start[col];
+        }
+
+        std::vector<int> order(triplets.size());
+        std::vector<int> position(column_start.begin(), column_start.end() - 1);
+        for (size_t i = 0; i < triplets.size(); i++)
+        {
+            order[position[triplets[i].col]++] = i;
+        }
+
+        // Sort each column by rows and merge duplicates
+        outer_index.assign(num_cols + 1, 0);
+        inner_index.clear();
+        value_params.clear();
+        inner_index.reserve(triplets.size());
+        value_params.reserve(triplets.size());
+
+        std::vector<Parameter> duplicates;
+        for (size_t col = 0; col < num_cols; col++)
+        {
+            auto begin = order.begin() + column_start[col];
+            auto end = order.begin() + column_start[col + 1];
+            std::stable_sort(begin, end, [&](int a, int b) { return triplets[a].row < triplets[b].row; });
+
+            for (auto it = begin; it != end;)
+            {
+                const int row = triplets[*it].row;
+                auto next = it + 1;
+                while (next != end and triplets[*next].row == row)
+                {
+                    ++next;
+                }
+
+                inner_index.push_back(row);
+                if (next - it == 1)
+                {
+                    value_params.push_back(std::move(list.coefficients[triplets[*it].coefficient]));
+                }
+                else
+                {
+                    duplicates.clear();
+                    for (auto dup = it; dup != next; ++dup)
+                    {
+                        duplicates.push_back(std::move(list.coefficients[triplets[*dup].coefficient]));
+                    }
+                    value_params.push_back(sum(duplicates));
+                }
+                it = next;
+            }
+            outer_index[col + 1] = inner_index.size();
+        }
+    }
+
+    void ParameterMatrix::appendTo(CoefficientList &list, size_t row_offset) const
+    {
+        list.reserve(list.size() + nonZeros());
+        for (size_t col = 0; col < num_cols; col++)
+        {
+            for (int k = outer_index[col]; k < outer_index[col + 1]; k++)
+            {
+                list.add(row_offset + inner_index[k], col, value_params[k]);
+            }
+        }
+    }
+
+    const int *ParameterMatrix::outerIndexPtr() const
+    {
+        return outer_index.data();
+    }
+
+    const int *ParameterMatrix::innerIndexPtr() const
+    {
+        return inner_index.data();
+    }
+
+    const std::vector<Parameter> &ParameterMatrix::values() const
+    {
+        return value_params;
+    }
+
+    Eigen::VectorXd ParameterMatrix::evalValues() const
+    {
+        Eigen::VectorXd values(nonZeros());
+        for (size_t k = 0; k < nonZeros(); k++)
+        {
+            values(k) = value_params[k].getValue();
+        }
+        return values;
+    }
+
+} // namespace cvx::internal
+
+namespace cvx
+{
+
+    Eigen::SparseMatrix<double> eval(const internal::ParameterMatrix &m)
+    {
+        const Eigen::VectorXd values = m.evalValues();
+        return Eigen::Map<const Eigen::SparseMatrix<double>>(m.rows(), m.cols(), m.nonZeros(),
+                                                             m.outerIndexPtr(), m.innerIndexPtr(), values.data());
+    }
+
+} // namespace cvx
@@ -0,0 +1,521 @@
+#include "wrappers/presolve.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <map>
+
+namespace cvx::internal
+{
+
+    namespace
+    {
+        const double infinity = std::numeric_limits<double>::max();
+
+        bool isInfinite(const Parameter &param)
+        {
+            return param.isConstant() and std::abs(param.getValue()) >= infinity;
+        }
+
+        // Multiply a bound with a constant, keeping infinite bounds infinite
+        Parameter scaleBound(const Parameter &bound, double scale)
+        {
+            if (isInfinite(bound))
+            {
+                return Parameter(std::copysign(infinity, bound.getValue() * scale));
+            }
+            return bound * Parameter(scale);
+        }
+
+        bool isEquality(Presolve::RowType type, const Parameter &lower, const Parameter &upper)
+        {
+            return type == Presolve::RowType::Equality or
+                   (type == Presolve::RowType::Range and lower == upper);
+        }
+
+        // Check if a row without variables holds, false if its bounds are not constant
+        bool isSatisfiedByZero(Presolve::RowType type, const Parameter &lower, const Parameter &upper)
+        {
+            const double tolerance = 1e-9;
+            if (not lower.isConstant() or (type == Presolve::RowType::Range and not upper.isConstant()))
+            {
+                return false;
+            }
+
+            switch (type)
+            {
+            case Presolve::RowType::Equality:
+                return std::abs(lower.getValue()) <= tolerance;
+            case Presolve::RowType::Inequality:
+                return lower.getValue() <= tolerance;
+            default: // Presolve::RowType::Range
+                return lower.getValue() <= tolerance and upper.getValue() >= -tolerance;
+            }
+        }
+    } // namespace
+
+    Presolve::Presolve(const ParameterMatrix &A,
+                       const VectorXp &lower,
+                       const VectorXp &upper,
+                       const std::vector<RowType> &row_types,
+                       const ParameterMatrix &P,
+                       const VectorXp &q)
+        : num_rows(A.rows())
+    {
+        const size_t num_columns = A.cols();
+
+        // Row-wise view of the constraint matrix
+        std::vector<std::vector<std::pair<size_t, Parameter>>> rows(num_rows);
+        std::vector<std::vector<std::pair<size_t, Parameter>>> columns(num_columns);
+        for (size_t col = 0; col < A.cols(); col++)
+        {
+            for (int k = A.outerIndexPtr()[col]; k < A.outerIndexPtr()[col + 1]; k++)
+            {
+                const size_t row = A.innerIndexPtr()[k];
+                rows[row].emplace_back(col, A.values()[k]);
+                columns[col].emplace_back(row, A.values()[k]);
+            }
+        }
+
+        auto isSingleton = [&](size_t row) {
+            return row_types[row] != RowType::Cone and
+                   rows[row].size() == 1 and
+                   rows[row].front().second.isConstant() and
+                   rows[row].front().second.getValue() != 0.;
+        };
+
+        // Find variables that are fixed by exactly one singleton equality row.
+        // Other singleton rows of these variables become empty and are removed.
+        std::vector<size_t> num_fixing_rows(num_columns, 0);
+        std::vector<size_t> fixing_row(num_columns, 0);
+        for (size_t row = 0; row < num_rows; row++)
+        {
+            if (isSingleton(row) and isEquality(row_types[row], lower(row), upper(row)))
+            {
+                const size_t col = rows[row].front().first;
+                num_fixing_rows[col]++;
+                fixing_row[col] = row;
+            }
+        }
+
+        column_map.resize(num_columns);
+        row_status.assign(num_rows, RowStatus::Kept);
+        row_map.assign(num_rows, 0);
+        std::vector<Parameter> fixed_value(num_columns);
+        std::vector<bool> is_fixed(num_columns, false);
+
+        size_t num_reduced_columns = 0;
+        for (size_t col = 0; col < num_columns; col++)
+        {
+            const bool is_last = num_reduced_columns == 0 and col + 1 == num_columns;
+            if (num_fixing_rows[col] == 1 and not is_last)
+            {
+                const size_t row = fixing_row[col];
+                const double coefficient = rows[row].front().second.getValue();
+
+                is_fixed[col] = true;
+                fixed_value[col] = lower(row) / Parameter(coefficient);
+                row_status[row] = RowStatus::Fixing;
+                column_map[col] = -1;
+
+                FixedColumn fixed;
+                fixed.column = col;
+                fixed.row = row;
+                fixed.coefficient = coefficient;
+                fixed.value = fixed_value[col];
+                for (const auto &[other_row, param] : columns[col])
+                {
+                    if (other_row != row)
+                    {
+                        fixed.column_entries.emplace_back(other_row, param);
+                    }
+                }
+                fixed.linear = q(col);
+                fixed_columns.push_back(fixed);
+            }
+            else
+            {
+                column_map[col] = num_reduced_columns++;
+            }
+        }
+
+        // Quadratic cost: entries between fixed and free variables become linear
+        q_reduced.resize(num_reduced_columns);
+        for (size_t col = 0; col < num_columns; col++)
+        {
+            if (not is_fixed[col])
+            {
+                q_reduced(column_map[col]) = q(col);
+            }
+        }
+
+        std::map<size_t, size_t> fixed_index;
+        for (size_t i = 0; i < fixed_columns.size(); i++)
+        {
+            fixed_index[fixed_columns[i].column] = i;
+        }
+
+        for (size_t col = 0; col < P.cols(); col++)
+        {
+            for (int k = P.outerIndexPtr()[col]; k < P.outerIndexPtr()[col + 1]; k++)
+            {
+                const size_t row = P.innerIndexPtr()[k];
+                const Parameter &value = P.values()[k];
+
+                if (is_fixed[row])
+                {
+                    fixed_columns[fixed_index[row]].quadratic_entries.emplace_back(col, value);
+                }
+                if (is_fixed[col] and row != col)
+                {
+                    fixed_columns[fixed_index[col]].quadratic_entries.emplace_back(row, value);
+                }
+
+                if (not is_fixed[row] and not is_fixed[col])
+                {
+                    P_reduced_coeffs.add(column_map[row], column_map[col], value);
+                }
+                else if (is_fixed[row] and not is_fixed[col])
+                {
+                    q_reduced(column_map[col]) += value * fixed_value[row];
+                }
+                else if (is_fixed[col] and not is_fixed[row])
+                {
+                    q_reduced(column_map[row]) += value * fixed_value[col];
+                }
+            }
+        }
+
+        // Group rows with identical coefficients
+        std::map<std::pair<RowType, std::vector<size_t>>, std::vector<size_t>> groups;
+
+        for (size_t row = 0; row < num_rows; row++)
+        {
+            if (row_status[row] == RowStatus::Fixing)
+            {
+                continue;
+            }
+
+            const RowType type = row_types[row];
+
+            // Substitute the fixed variables
+            std::vector<std::pair<size_t, Parameter>> coefficients;
+            Parameter shift;
+            for (const auto &[col, param] : rows[row])
+            {
+                if (is_fixed[col])
+                {
+                    shift += param * fixed_value[col];
+                }
+                else
+                {
+                    coefficients.emplace_back(column_map[col], param);
+                }
+            }
+
+            Parameter row_lower = isInfinite(lower(row)) ? lower(row) : lower(row) - shift;
+            Parameter row_upper = type != RowType::Range or isInfinite(upper(row)) ? upper(row) : upper(row) - shift;
+
+            // Rows without variables are kept if they are violated or their bounds are dynamic,
+            // so the solver still sees an infeasible problem
+            if (coefficients.empty() and type != RowType::Cone and isSatisfiedByZero(type, row_lower, row_upper))
+            {
+                row_status[row] = RowStatus::Removed;
+                continue;
+            }
+
+            // Scale singleton rows to a unit coefficient
+            double scale = 1.;
+            if (type != RowType::Cone and
+                coefficients.size() == 1 and
+                coefficients.front().second.isConstant() and
+                coefficients.front().second.getValue() != 0.)
+            {
+                const double coefficient = coefficients.front().second.getValue();
+
+                // Inequalities must keep their direction
+                scale = type == RowType::Inequality ? 1. / std::abs(coefficient) : 1. / coefficient;
+                coefficients.front().second = Parameter(coefficient * scale);
+                row_lower = scaleBound(row_lower, scale);
+                row_upper = scaleBound(row_upper, scale);
+                if (scale < 0.)
+                {
+                    std::swap(row_lower, row_upper);
+                }
+            }
+
+            const Member member{row, scale, row_lower, row_upper};
+
+            // Look for a row with the same coefficients
+            if (type != RowType::Cone)
+            {
+                std::vector<size_t> pattern;
+                for (const auto &coefficient : coefficients)
+                {
+                    pattern.push_back(coefficient.first);
+                }
+
+                std::vector<size_t> &candidates = groups[{type, pattern}];
+                bool merged = false;
+                for (size_t candidate : candidates)
+                {
+                    ReducedRow &reduced_row = reduced_rows[candidate];
+
+                    bool same = reduced_row.coefficients.size() == coefficients.size();
+                    for (size_t i = 0; same and i < coefficients.size(); i++)
+                    {
+                        same = reduced_row.coefficients[i].second == coefficients[i].second;
+                    }
+
+                    // Equality rows can only be merged if they are identical
+                    if (type == RowType::Equality)
+                    {
+                        same = same and reduced_row.members.front().lower == row_lower;
+                    }
+
+                    if (same)
+                    {
+                        reduced_row.members.push_back(member);
+                        row_map[row] = candidate;
+                        merged = true;
+                        break;
+                    }
+                }
+
+                if (merged)
+                {
+                    continue;
+                }
+
+                candidates.push_back(reduced_rows.size());
+            }
+
+            row_map[row] = reduced_rows.size();
+            reduced_rows.push_back({type, coefficients, {member}, Parameter(), Parameter()});
+        }
+
+        // Use the tightest bounds of all merged rows
+        for (ReducedRow &reduced_row : reduced_rows)
+        {
+            reduced_row.lower = reduced_row.members.front().lower;
+            reduced_row.upper = reduced_row.members.front().upper;
+
+            if (reduced_row.members.size() == 1)
+            {
+                continue;
+            }
+
+            for (size_t i = 1; i < reduced_row.members.size(); i++)
+            {
+                const Member &member = reduced_row.members[i];
+                row_status[member.row] = RowStatus::Merged;
+
+                if (reduced_row.type == RowType::Equality)
+                {
+                    continue;
+                }
+
+                if (not isInfinite(member.lower))
+                {
+                    reduced_row.lower = isInfinite(reduced_row.lower) ? member.lower : max(reduced_row.lower, member.lower);
+                }
+                if (reduced_row.type == RowType::Range and not isInfinite(member.upper))
+                {
+                    reduced_row.upper = isInfinite(reduced_row.upper) ? member.upper : min(reduced_row.upper, member.upper);
+                }
+            }
+            row_status[reduced_row.members.front().row] = RowStatus::Merged;
+        }
+    }
+
+    size_t Presolve::getNumReducedRows() const
+    {
+        return reduced_rows.size();
+    }
+
+    size_t Presolve::getNumReducedColumns() const
+    {
+        return column_map.size() - fixed_columns.size();
+    }
+
+    size_t Presolve::getNumReducedRows(RowType type) const
+    {
+        return std::count_if(reduced_rows.begin(), reduced_rows.end(),
+                             [type](const ReducedRow &row) { return row.type == type; });
+    }
+
+    ParameterMatrix Presolve::getReducedMatrix(size_t first_row, size_t num_rows) const
+    {
+        CoefficientList coeffs;
+        for (size_t row = 0; row < num_rows; row++)
+        {
+            for (const auto &[col, param] : reduced_rows[first_row + row].coefficients)
+            {
+                coeffs.add(row, col, param);
+            }
+        }
+
+        ParameterMatrix matrix(num_rows, getNumReducedColumns());
+        matrix.setFromCoefficients(coeffs);
+        return matrix;
+    }
+
+    Presolve::VectorXp Presolve::getReducedLower(size_t first_row, size_t num_rows) const
+    {
+        VectorXp lower(num_rows);
+        for (size_t row = 0; row < num_rows; row++)
+        {
+            lower(row) = reduced_rows[first_row + row].lower;
+        }
+        return lower;
+    }
+
+    Presolve::VectorXp Presolve::getReducedUpper(size_t first_row, size_t num_rows) const
+    {
+        VectorXp upper(num_rows);
+        for (size_t row = 0; row < num_rows; row++)
+        {
+            upper(row) = reduced_rows[first_row + row].upper;
+        }
+        return upper;
+    }
+
+    ParameterMatrix Presolve::getReducedQuadraticCost() const
+    {
+        CoefficientList coeffs = P_reduced_coeffs;
+        ParameterMatrix P(getNumReducedColumns(), getNumReducedColumns());
+        P.setFromCoefficients(coeffs);
+        return P;
+    }
+
+    Presolve::VectorXp Presolve::getReducedLinearCost() const
+    {
+        return q_reduced;
+    }
+
+    Presolve::RowStatus Presolve::getRowStatus(size_t row) const
+    {
+        return row_status[row];
+    }
+
+    size_t Presolve::getReducedRow(size_t row) const
+    {
+        return row_map[row];
+    }
+
+    void Presolve::postsolvePrimal(const double *x_reduced, std::vector<double> &x) const
+    {
+        for (size_t col = 0; col < column_map.size(); col++)
+        {
+            if (column_map[col] >= 0)
+            {
+                x[col] = x_reduced[column_map[col]];
+            }
+        }
+        for (const FixedColumn &fixed : fixed_columns)
+        {
+            x[fixed.column] = fixed.value.getValue();
+        }
+    }
+
+    void Presolve::postsolvePrimal(const double *x_reduced, const Eigen::VectorXd &fixed_values, std::vector<double> &x) const
+    {
+        assert(size_t(fixed_values.size()) == fixed_columns.size());
+
+        for (size_t col = 0; col < column_map.size(); col++)
+        {
+            if (column_map[col] >= 0)
+            {
+                x[col] = x_reduced[column_map[col]];
+            }
+        }
+        for (size_t i = 0; i < fixed_columns.size(); i++)
+        {
+            x[fixed_columns[i].column] = fixed_values(i);
+        }
+    }
+
+    std::vector<Parameter> Presolve::getFixedValues() const
+    {
+        std::vector<Parameter> values;
+        values.reserve(fixed_columns.size());
+        for (const FixedColumn &fixed : fixed_columns)
+        {
+            values.push_back(fixed.value);
+        }
+        return values;
+    }
+
+    void Presolve::postsolveDual(const std::vector<double> &x,
+                                 const double *y_reduced,
+                                 double sign,
+                                 Eigen::VectorXd &y) const
+    {
+        y.setZero(num_rows);
+
+        // Assign the dual of a merged row to the member that defines the active bound
+        for (size_t i = 0; i < reduced_rows.size(); i++)
+        {
+            const ReducedRow &reduced_row = reduced_rows[i];
+            const double dual = y_reduced[i];
+
+            const Member *active = &reduced_row.members.front();
+            if (reduced_row.members.size() > 1 and reduced_row.type != RowType::Equality)
+            {
+                const bool upper_active = reduced_row.type == RowType::Range and dual > 0.;
+                for (const Member &member : reduced_row.members)
+                {
+                    if (upper_active ? member.upper.getValue() < active->upper.getValue()
+                                     : member.lower.getValue() > active->lower.getValue())
+                    {
+                        active = &member;
+                    }
+                }
+            }
+            y(active->row) = dual * active->scale;
+        }
+
+        // Recover the duals of fixing rows from stationarity
+        for (const FixedColumn &fixed : fixed_columns)
+        {
+            double gradient = fixed.linear.getValue();
+            for (const auto &[col, param] : fixed.quadratic_entries)
+            {
+                gradient += param.getValue() * x[col];
+            }
+            for (const auto &[row, param] : fixed.column_entries)
+            {
+                gradient += sign * param.getValue() * y(row);
+            }
+            y(fixed.row) = -gradient / (sign * fixed.coefficient);
+        }
+    }
+
+    Eigen::VectorXd Presolve::reducePrimal(const std::vector<double> &x) const
+    {
+        Eigen::VectorXd x_reduced(getNumReducedColumns());
+        for (size_t col = 0; col < column_map.size(); col++)
+        {
+            if (column_map[col] >= 0)
+            {
+                x_reduced(column_map[col]) = x[col];
+            }
+        }
+        return x_reduced;
+    }
+
+    Eigen::VectorXd Presolve::reduceDual(const Eigen::VectorXd &y) const
+    {
+        Eigen::VectorXd y_reduced = Eigen::VectorXd::Zero(reduced_rows.size());
+        for (size_t i = 0; i < reduced_rows.size(); i++)
+        {
+            for (const Member &member : reduced_rows[i].members)
+            {
+                y_reduced(i) += y(member.row) / member.scale;
+            }
+        }
+        return y_reduced;
+    }
+
+} // namespace cvx
@@ -1,19 +1,84 @@
 #include "wrappers/qpWrapperBase.hpp"
+#include "wrappers/parallel.hpp"
 
 #include <Eigen/Cholesky>
 
 namespace cvx::internal
 {
 
-    QPWrapperBase::QPWrapperBase(OptimizationProblem &problem)
+    bool QPWrapperBase::canonicalizeNewConstraints()
     {
-        std::vector<Eigen::Triplet<Parameter>> A_coeffs, P_coeffs;
+        if (not problem.second_order_cone_constraints.empty() or
+            not problem.rotated_second_order_cone_constraints.empty())
+        {
+            throw std::runtime_error("Second order cone constraints can not be solved as a QP. Use a second order cone solver instead.");
+        }
+
+        CoefficientList A_coeffs;
         std::vector<Parameter> l_coeffs, u_coeffs;
 
+        // Counting pass: reserve the storage for the new rows and their nonzeros
+        size_t num_rows = 0;
+        size_t num_nonzeros = 0;
+        for (size_t i = num_equality_constraints; i < problem.equality_constraints.size(); i++)
+        {
+            num_rows++;
+            num_nonzeros += problem.equality_constraints[i].affine.terms.size();
+        }
+        for (size_t i = num_positive_constraints; i < problem.positive_constraints.size(); i++)
+        {
+            const PositiveConstraint &constraint = problem.positive_constraints[i];
+            num_rows++;
+            num_nonzeros += constraint.affine.terms.size();
+            countSlacks(constraint.piecewise_linear, num_rows, num_nonzeros);
+        }
+        for (size_t i = num_box_constraints; i < problem.box_constraints.size(); i++)
+        {
+            const BoxConstraint &constraint = problem.box_constraints[i];
+            num_rows += 2;
+            num_nonzeros += 2 * (constraint.lower.terms.size() + constraint.middle.terms.size() + constraint.upper.terms.size());
+        }
+        A_coeffs.reserve(num_nonzeros + A_params.nonZeros());
+        l_coeffs.reserve(num_rows);
+        u_coeffs.reserve(num_rows);
+
+        // New rows are appended to the existing ones
+        const size_t first_row = A_params.rows();
+
+        // Clean up the expressions of the new constraints on multiple threads. Each constraint is
+        // processed exactly as in the loops below, which only number the variables and rows in order.
+        parallelFor(num_equality_constraints, problem.equality_constraints.size(), [&](size_t i) {
+            problem.equality_constraints[i].affine.cleanUp();
+        });
+        parallelFor(num_positive_constraints, problem.positive_constraints.size(), [&](size_t i) {
+            PositiveConstraint &constraint = problem.positive_constraints[i];
+            if (constraint.piecewise_linear.empty())
+            {
+                constraint.affine.cleanUp();
+            }
+        });
+        std::vector<std::pair<Affine, Affine>> box_rows(problem.box_constraints.size() - num_box_constraints);
+        parallelFor(num_box_constraints, problem.box_constraints.size(), [&](size_t i) {
+            BoxConstraint &constraint = problem.box_constraints[i];
+            if (constraint.lower.isConstant() and constraint.upper.isConstant())
+            {
+                constraint.middle.cleanUp();
+            }
+            else
+            {
+                // c_lower - c_middle <= middle - lower and c_middle - c_upper <= upper - middle
+                auto &[middle_m_lower, upper_m_middle] = box_rows[i - num_box_constraints];
+                middle_m_lower = constraint.middle - constraint.lower;
+                middle_m_lower.cleanUp();
+                upper_m_middle = constraint.upper - constraint.middle;
+                upper_m_middle.cleanUp();
+            }
+        });
+
         // Build equality constraint parameters
-        for (internal::EqualityConstraint &constraint : problem.equality_constraints)
+        for (size_t i = num_equality_constraints; i < problem.equality_constraints.size(); i++)
         {
-            constraint.affine.cleanUp();
+            internal::EqualityConstraint &constraint = problem.equality_constraints[i];
             if (constraint.affine.isConstant())
             {
                 continue;
@@ -22,41 +87,62 @@ namespace cvx::internal
             for (Term &term : constraint.affine.terms)
             {
                 addVariable(term.variable);
-                A_coeffs.emplace_back(u_coeffs.size(),
+                A_coeffs.add(first_row + u_coeffs.size(),
                                       term.variable.getProblemIndex(),
                                       term.parameter);
             }
+            addRowToBlocks(constraint_rows, constraint.source, first_row + u_coeffs.size(), Constraint::Equality, 1);
             l_coeffs.push_back(Parameter(-1.) * constraint.affine.constant);
             u_coeffs.push_back(Parameter(-1.) * constraint.affine.constant);
         }
 
-        // Build positive constraint parameters
-        for (internal::PositiveConstraint &constraint : problem.positive_constraints)
-        {
-            constraint.affine.cleanUp();
-            if (constraint.affine.isConstant())
+        // Build positive constraint parameters from clean expressions
+        auto add_positive_row = [&](Affine &affine, const std::shared_ptr<ConstraintSource> &source, size_t num_rows) {
+            if (affine.isConstant())
             {
-                continue;
+                return;
             }
 
-            for (Term &term : constraint.affine.terms)
+            for (Term &term : affine.terms)
             {
                 addVariable(term.variable);
-                A_coeffs.emplace_back(u_coeffs.size(),
+                A_coeffs.add(first_row + u_coeffs.size(),
                                       term.variable.getProblemIndex(),
                                       term.parameter);
             }
-            l_coeffs.push_back(Parameter(-1.) * constraint.affine.constant);
+            addRowToBlocks(constraint_rows, source, first_row + u_coeffs.size(), Constraint::Positive, num_rows);
+            l_coeffs.push_back(Parameter(-1.) * affine.constant);
             u_coeffs.push_back(Parameter(std::numeric_limits<double>::max()));
+        };
+
+        for (size_t i = num_positive_constraints; i < problem.positive_constraints.size(); i++)
+        {
+            internal::PositiveConstraint &constraint = problem.positive_constraints[i];
+            if (constraint.piecewise_linear.empty())
+            {
+                add_positive_row(constraint.affine, constraint.source, 1);
+                continue;
+            }
+
+            // sum(slacks) <= affine with the rows of the slacks
+            std::vector<Affine> slack_rows;
+            Affine affine = constraint.affine - addSlacks(constraint.piecewise_linear, slack_rows);
+            affine.cleanUp();
+            add_positive_row(affine, constraint.source, slack_rows.size() + 1);
+            for (Affine &row : slack_rows)
+            {
+                row.cleanUp();
+                add_positive_row(row, constraint.source, slack_rows.size() + 1);
+            }
         }
 
         // Build box constraint parameters
-        for (internal::BoxConstraint &constraint : problem.box_constraints)
+        for (size_t i = num_box_constraints; i < problem.box_constraints.size(); i++)
         {
+            internal::BoxConstraint &constraint = problem.box_constraints[i];
             if (constraint.lower.isConstant() and constraint.upper.isConstant())
             {
                 // lower <= middle <= upper
-                constraint.middle.cleanUp();
                 if (constraint.middle.isConstant())
                 {
                     continue;
@@ -65,67 +151,176 @@ namespace cvx::internal
                 for (Term &term : constraint.middle.terms)
                 {
                     addVariable(term.variable);
-                    A_coeffs.emplace_back(u_coeffs.size(),
+                    A_coeffs.add(first_row + u_coeffs.size(),
                                           term.variable.getProblemIndex(),
                                           term.parameter);
                 }
+                addRowToBlocks(constraint_rows, constraint.source, first_row + u_coeffs.size(), Constraint::Box, 1);
                 l_coeffs.push_back(constraint.lower.constant - constraint.middle.constant);
                 u_coeffs.push_back(constraint.upper.constant - constraint.middle.constant);
             }
             else
             {
-                // c_lower - c_middle <= middle - lower <= inf
-                Affine middle_m_lower = constraint.middle - constraint.lower;
-                middle_m_lower.cleanUp();
+                auto &[middle_m_lower, upper_m_middle] = box_rows[i - num_box_constraints];
+                const size_t num_rows = size_t(middle_m_lower.isFirstOrder()) + size_t(upper_m_middle.isFirstOrder());
 
+                // c_lower - c_middle <= middle - lower <= inf
                 if (middle_m_lower.isFirstOrder())
                 {
                     for (Term &term : middle_m_lower.terms)
                     {
                         addVariable(term.variable);
-                        A_coeffs.emplace_back(u_coeffs.size(),
+                        A_coeffs.add(first_row + u_coeffs.size(),
                                               term.variable.getProblemIndex(),
                                               term.parameter);
                     }
+                    addRowToBlocks(constraint_rows, constraint.source, first_row + u_coeffs.size(), Constraint::Box, num_rows);
                     l_coeffs.push_back(constraint.lower.constant - constraint.middle.constant);
                     u_coeffs.push_back(Parameter(std::numeric_limits<double>::max()));
                 }
 
                 // c_middle - c_upper <= upper - middle <= inf
-                Affine upper_m_middle = constraint.upper - constraint.middle;
-                upper_m_middle.cleanUp();
-
                 if (upper_m_middle.isFirstOrder())
                 {
                     for (Term &term : upper_m_middle.terms)
                     {
                         addVariable(term.variable);
-                        A_coeffs.emplace_back(u_coeffs.size(),
+                        A_coeffs.add(first_row + u_coeffs.size(),
                                               term.variable.getProblemIndex(),
                                               term.parameter);
                     }
+                    addRowToBlocks(constraint_rows, constraint.source, first_row + u_coeffs.size(), Constraint::Box, num_rows);
                     l_coeffs.push_back(constraint.middle.constant - constraint.upper.constant);
                     u_coeffs.push_back(Parameter(std::numeric_limits<double>::max()));
                 }
             }
         }
 
-        // Build cost function
-        if (problem.costFunction.getOrder() == 0 or problem.costFunction.isNorm())
+        num_equality_constraints = problem.equality_constraints.size();
+        num_positive_constraints = problem.positive_constraints.size();
+        num_box_constraints = problem.box_constraints.size();
+
+        assert(l_coeffs.size() == u_coeffs.size());
+
+        if (l_coeffs.empty())
+        {
+            return false;
+        }
+
+        appendRows(A_coeffs, l_coeffs, u_coeffs);
+
+        return true;
+    }
+
+    void QPWrapperBase::appendRows(CoefficientList &A_coeffs,
+                                   std::vector<Parameter> &l_coeffs,
+                                   std::vector<Parameter> &u_coeffs)
+    {
+        const size_t first_row = A_params.rows();
+
+        // Keep the existing coefficients
+        A_params.appendTo(A_coeffs);
+
+        A_params.resize(first_row + l_coeffs.size(), getNumVariables());
+        A_params.setFromCoefficients(A_coeffs);
+
+        l_params.conservativeResize(A_params.rows());
+        u_params.conservativeResize(A_params.rows());
+        l_params.tail(l_coeffs.size()) = Eigen::Map<VectorXp>(l_coeffs.data(), l_coeffs.size());
+        u_params.tail(u_coeffs.size()) = Eigen::Map<VectorXp>(u_coeffs.data(), u_coeffs.size());
+
+        // New variables only appear in the new constraints
+        q_params.conservativeResize(getNumVariables());
+        P_params.conservativeResize(getNumVariables(), getNumVariables());
+        solution->resize(getNumVariables());
+
+        dual_rows = constraint_rows;
+        num_dual_rows = A_params.rows();
+    }
+
+    void QPWrapperBase::liftSquare(Affine &affine,
+                                   const Parameter &weight,
+                                   CoefficientList &P_coeffs,
+                                   CoefficientList &A_coeffs,
+                                   std::vector<Parameter> &l_coeffs,
+                                   std::vector<Parameter> &u_coeffs)
+    {
+        // y == a'x + b
+        const size_t row = A_params.rows() + l_coeffs.size();
+
+        Variable lifted("lifted", num_lifted++);
+        addVariable(lifted);
+        A_coeffs.add(row, lifted.getProblemIndex(), Parameter(1.));
+
+        for (Term &term : affine.terms)
+        {
+            addVariable(term.variable);
+            A_coeffs.add(row, term.variable.getProblemIndex(), -term.parameter);
+        }
+        l_coeffs.push_back(affine.constant);
+        u_coeffs.push_back(affine.constant);
+
+        // y^2 with the doubled diagonal element
+        P_coeffs.add(lifted.getProblemIndex(), lifted.getProblemIndex(), Parameter(2.) * weight);
+    }
+
+    void QPWrapperBase::addCost(Scalar &cost,
+                                const Parameter &weight,
+                                CoefficientList &q_coeffs,
+                                CoefficientList &P_coeffs,
+                                CoefficientList &A_coeffs,
+                                std::vector<Parameter> &l_coeffs,
+                                std::vector<Parameter> &u_coeffs)
+    {
+        if (cost.isNorm())
         {
             throw std::runtime_error("QP cost functions must be linear or quadratic.");
         }
 
         // Linear part
-        for (Term &term : problem.costFunction.affine.terms)
+        for (Term &term : cost.affine.terms)
         {
             addVariable(term.variable);
-            q_params(term.variable.getProblemIndex()) += term.parameter;
+            q_coeffs.add(term.variable.getProblemIndex(), 0, weight * term.parameter);
+        }
+
+        // Piecewise linear part: weighted slacks in the cost, slack - a'x - b >= 0 in the constraints
+        if (not cost.piecewise_linear.empty())
+        {
+            checkPiecewiseLinearCost(cost.piecewise_linear);
+
+            std::vector<Affine> slack_rows;
+            Affine slacks = addSlacks(cost.piecewise_linear, slack_rows);
+            for (Term &term : slacks.terms)
+            {
+                addVariable(term.variable);
+                q_coeffs.add(term.variable.getProblemIndex(), 0, weight * term.parameter);
+            }
+
+            for (Affine &row : slack_rows)
+            {
+                for (Term &term : row.terms)
+                {
+                    addVariable(term.variable);
+                    A_coeffs.add(A_params.rows() + l_coeffs.size(),
+                                          term.variable.getProblemIndex(),
+                                          term.parameter);
+                }
+                l_coeffs.push_back(Parameter(-1.) * row.constant);
+                u_coeffs.push_back(Parameter(std::numeric_limits<double>::max()));
+            }
         }
 
         // Quadratic part
-        for (Product &product : problem.costFunction.products)
+        for (Product &product : cost.products)
         {
+            // Expanding a square with many terms results in a dense block in P
+            if (product.isSquare() and product.firstTerm().terms.size() >= min_lifted_terms)
+            {
+                liftSquare(product.firstTerm(), weight, P_coeffs, A_coeffs, l_coeffs, u_coeffs);
+                continue;
+            }
+
             for (Term &term1 : product.firstTerm().terms)
             {
                 for (Term &term2 : product.secondTerm().terms)
@@ -136,7 +331,7 @@ namespace cvx::internal
                     const std::pair<size_t, size_t> sorted = std::minmax(term1.variable.getProblemIndex(),
                                                                          term2.variable.getProblemIndex());
 
-                    Parameter param = term1.parameter * term2.parameter;
+                    Parameter param = weight * term1.parameter * term2.parameter;
 
                     // Explicitly double diagonal elements
                     if (sorted.first == sorted.second)
@@ -144,7 +339,7 @@ namespace cvx::internal
                         param *= Parameter(2.);
                     }
 
-                    P_coeffs.emplace_back(sorted.first,
+                    P_coeffs.add(sorted.first,
                                           sorted.second,
                                           param);
                 }
@@ -156,7 +351,7 @@ namespace cvx::internal
                 for (Term &term : product.secondTerm().terms)
                 {
                     addVariable(term.variable);
-                    q_params(term.variable.getProblemIndex()) += product.firstTerm().constant * term.parameter;
+                    q_coeffs.add(term.variable.getProblemIndex(), 0, weight * product.firstTerm().constant * term.parameter);
                 }
             }
             if (not product.secondTerm().constant.isZero())
@@ -164,24 +359,157 @@ namespace cvx::internal
                 for (Term &term : product.firstTerm().terms)
                 {
                     addVariable(term.variable);
-                    q_params(term.variable.getProblemIndex()) += product.secondTerm().constant * term.parameter;
+                    q_coeffs.add(term.variable.getProblemIndex(), 0, weight * product.secondTerm().constant * term.parameter);
                 }
             }
         }
 
-        assert(l_coeffs.size() == u_coeffs.size());
+        // Quadratic forms: copy the upper triangular part
+        for (QuadForm &quad_form : cost.quad_forms)
+        {
+            for (int k = 0; k < quad_form.Q.outerSize(); k++)
+            {
+                for (Eigen::SparseMatrix<Parameter>::InnerIterator it(quad_form.Q, k); it; ++it)
+                {
+                    Affine &x_i = quad_form.x[it.row()];
+                    Affine &x_j = quad_form.x[it.col()];
+
+                    // Off-diagonal elements appear twice in x' * Q * x
+                    const Parameter factor = weight * it.value() * Parameter(it.row() == it.col() ? 1. : 2.);
+
+                    if (not x_i.terms.empty() and not x_j.terms.empty())
+                    {
+                        Term &term_i = x_i.terms.front();
+                        Term &term_j = x_j.terms.front();
+                        addVariable(term_i.variable);
+                        addVariable(term_j.variable);
+
+                        const std::pair<size_t, size_t> sorted = std::minmax(term_i.variable.getProblemIndex(),
+                                                                             term_j.variable.getProblemIndex());
+
+                        Parameter param = factor * term_i.parameter * term_j.parameter;
+
+                        // Explicitly double diagonal elements
+                        if (sorted.first == sorted.second)
+                        {
+                            param *= Parameter(2.);
+                        }
+
+                        P_coeffs.add(sorted.first, sorted.second, param);
+                    }
+
+                    // The linear parts from the constants
+                    if (not x_i.terms.empty() and not x_j.constant.isZero())
+                    {
+                        Term &term = x_i.terms.front();
+                        addVariable(term.variable);
+                        q_coeffs.add(term.variable.getProblemIndex(), 0, factor * x_j.constant * term.parameter);
+                    }
+                    if (not x_j.terms.empty() and not x_i.constant.isZero())
+                    {
+                        Term &term = x_j.terms.front();
+                        addVariable(term.variable);
+                        q_coeffs.add(term.variable.getProblemIndex(), 0, factor * x_i.constant * term.parameter);
+                    }
+                }
+            }
+        }
+    }
 
-        // Fill matrices and vectors
-        A_params.resize(l_coeffs.size(), getNumVariables());
+    QPWrapperBase::QPWrapperBase(OptimizationProblem &problem, bool presolve)
+        : problem(problem)
+    {
+        // Build constraint parameters
+        canonicalizeNewConstraints();
+
+        // Build cost function
+        bool has_cost = problem.costFunction.getOrder() > 0;
+        for (const auto &[name, cost_slot] : problem.cost_slots)
+        {
+            has_cost |= cost_slot.cost.getOrder() > 0;
+        }
+        if (not has_cost)
+        {
+            throw std::runtime_error("QP cost functions must be linear or quadratic.");
+        }
+
+        // Counting pass: reserve the storage for the cost coefficients
+        size_t num_linear = 0;
+        size_t num_quadratic = 0;
+        countCost(problem.costFunction, num_linear, num_quadratic);
+        for (const auto &[name, cost_slot] : problem.cost_slots)
+        {
+            countCost(cost_slot.cost, num_linear, num_quadratic);
+        }
+        CoefficientList q_coeffs, P_coeffs;
+        q_coeffs.reserve(num_linear);
+        P_coeffs.reserve(num_quadratic);
+
+        // Rows of lifted squares and slack variables
+        CoefficientList cost_A_coeffs;
+        std::vector<Parameter> cost_l_coeffs, cost_u_coeffs;
+
+        addCost(problem.costFunction, Parameter(1.), q_coeffs, P_coeffs, cost_A_coeffs, cost_l_coeffs, cost_u_coeffs);
+
+        // Cost slots are scaled with their dynamic weights
+        for (auto &[name, cost_slot] : problem.cost_slots)
+        {
+            addCost(cost_slot.cost, Parameter(&cost_slot.weight), q_coeffs, P_coeffs, cost_A_coeffs, cost_l_coeffs, cost_u_coeffs);
+        }
+
+        // Fill matrices and vectors, all variables are known at this point
+        if (not cost_l_coeffs.empty())
+        {
+            appendRows(cost_A_coeffs, cost_l_coeffs, cost_u_coeffs);
+        }
+        A_params.conservativeResize(A_params.rows(), getNumVariables());
         P_params.resize(getNumVariables(), getNumVariables());
 
-        A_params.setFromTriplets(A_coeffs.begin(), A_coeffs.end());
-        P_params.setFromTriplets(P_coeffs.begin(), P_coeffs.end());
+        P_params.setFromCoefficients(P_coeffs);
+
+        q_params.conservativeResize(getNumVariables());
+        addCoefficients(q_coeffs, q_params);
 
-        l_params = Eigen::Map<VectorXp>(l_coeffs.data(), l_coeffs.size());
-        u_params = Eigen::Map<VectorXp>(u_coeffs.data(), u_coeffs.size());
+        cost_revision = problem.cost_revision;
 
         solution->resize(getNumVariables());
+
+        if (presolve)
+        {
+            presolveProblem();
+        }
+    }
+
+    void QPWrapperBase::presolveProblem()
+    {
+        const std::vector<Presolve::RowType> row_types(A_params.rows(), Presolve::RowType::Range);
+        presolve = std::make_unique<Presolve>(A_params, l_params, u_params, row_types, P_params, q_params);
+
+        const size_t m = presolve->getNumReducedRows();
+        A_params = presolve->getReducedMatrix(0, m);
+        l_params = presolve->getReducedLower(0, m);
+        u_params = presolve->getReducedUpper(0, m);
+        P_params = presolve->getReducedQuadraticCost();
+        q_params = presolve->getReducedLinearCost();
+
+        reduceRowBlocks(constraint_rows, 0, 0);
+    }
+
+    void QPWrapperBase::addNewConstraints()
+    {
+        if (problem.cost_revision != cost_revision)
+        {
+            throw std::runtime_error("The cost function has been changed after creating the solver. Create a new solver instead.");
+        }
+        if (presolve)
+        {
+            throw std::runtime_error("Constraints can not be added to a presolved problem. Create a new solver instead.");
+        }
+
+        if (canonicalizeNewConstraints())
+        {
+            rebuildWorkspace();
+        }
     }
 
     size_t QPWrapperBase::getNumInequalityConstraints() const
@@ -195,10 +523,27 @@ namespace cvx::internal
         if (was_linked)
         {
             variables.push_back(variable);
-            q_params.conservativeResize(getNumVariables());
         }
     }
 
+    bool QPWrapperBase::relaxDisabledRows(Eigen::Ref<Eigen::VectorXd> l, Eigen::Ref<Eigen::VectorXd> u) const
+    {
+        checkPresolvedRows();
+
+        bool any_disabled = false;
+        for (const RowBlock &block : constraint_rows)
+        {
+            if (not block.source->enabled)
+            {
+                l.segment(block.start, block.size).setConstant(-std::numeric_limits<double>::max());
+                u.segment(block.start, block.size).setConstant(std::numeric_limits<double>::max());
+                any_disabled = true;
+            }
+        }
+
+        return any_disabled;
+    }
+
     std::ostream &operator<<(std::ostream &os, const QPWrapperBase &wrapper)
     {
         Eigen::MatrixXd A = eval(wrapper.A_params);
@@ -235,7 +580,7 @@ namespace cvx::internal
         }
         else
         {
-            Eigen::LLT<Eigen::MatrixXd> llt(eval(P_params));
+            Eigen::LLT<Eigen::MatrixXd> llt(Eigen::MatrixXd(eval(P_params)));
             return llt.info() != Eigen::NumericalIssue;
         }
     }
@@ -245,7 +590,10 @@ namespace cvx::internal
         Eigen::SparseMatrix<double> A = eval(A_params);
         Eigen::VectorXd l = eval(l_params);
         Eigen::VectorXd u = eval(u_params);
-        Eigen::VectorXd Ax = A * Eigen::Map<Eigen::VectorXd>((*solution).data(), (*solution).size());
+        relaxDisabledRows(l, u);
+        const Eigen::VectorXd x = presolve ? presolve->reducePrimal(*solution)
+                                           : Eigen::Map<Eigen::VectorXd>((*solution).data(), (*solution).size()).eval();
+        Eigen::VectorXd Ax = A * x;
         return ((Ax - l).array() > -tolerance).all() && ((Ax - u).array() < tolerance).all();
     }
 
@@ -1,18 +1,151 @@
 #include "wrappers/socpWrapperBase.hpp"
+#include "wrappers/parallel.hpp"
+
+#include <Eigen/Cholesky>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
 
 namespace cvx::internal
 {
 
-    SOCPWrapperBase::SOCPWrapperBase(OptimizationProblem &problem)
+    bool SOCPWrapperBase::canonicalizeNewConstraints()
     {
-        std::vector<Eigen::Triplet<Parameter>> A_coeffs, G_coeffs;
-        std::vector<Parameter> b_coeffs, h_coeffs;
+        CoefficientList A_coeffs, G_coeffs, G_cone_coeffs;
+        std::vector<Parameter> b_coeffs, h_coeffs, h_cone_coeffs;
+        std::vector<RowBlock> linear_rows, cone_rows;
         std::vector<int> cone_dimensions;
 
-        // Build equality constraint parameters (b - A * x == 0)
-        for (internal::EqualityConstraint &constraint : problem.equality_constraints)
+        // Counting pass: reserve the storage for the new rows and their nonzeros
+        size_t num_equality_rows = 0, num_equality_nonzeros = 0;
+        for (size_t i = num_equality_constraints; i < problem.equality_constraints.size(); i++)
+        {
+            num_equality_rows++;
+            num_equality_nonzeros += problem.equality_constraints[i].affine.terms.size();
+        }
+
+        size_t num_linear_rows = 0, num_linear_nonzeros = 0;
+        auto count_positive_constraint = [&](const PositiveConstraint &constraint) {
+            num_linear_rows++;
+            num_linear_nonzeros += constraint.affine.terms.size();
+            countSlacks(constraint.piecewise_linear, num_linear_rows, num_linear_nonzeros);
+        };
+        for (size_t i = num_positive_constraints; i < problem.positive_constraints.size(); i++)
+        {
+            count_positive_constraint(problem.positive_constraints[i]);
+        }
+        for (const PositiveConstraint &constraint : cost_rows)
+        {
+            count_positive_constraint(constraint);
+        }
+        for (size_t i = num_box_constraints; i < problem.box_constraints.size(); i++)
         {
+            const BoxConstraint &constraint = problem.box_constraints[i];
+            num_linear_rows += 2;
+            num_linear_nonzeros += 2 * (constraint.lower.terms.size() + constraint.middle.terms.size() + constraint.upper.terms.size());
+        }
+
+        size_t num_cones = 0, num_cone_rows = 0, num_cone_nonzeros = 0;
+        auto count_norm = [&](const std::vector<Affine> &norm) {
+            num_cones++;
+            num_cone_rows += norm.size() + 1;
+            for (const Affine &affine : norm)
+            {
+                num_cone_nonzeros += affine.terms.size();
+            }
+        };
+        for (size_t i = num_cone_constraints; i < problem.second_order_cone_constraints.size(); i++)
+        {
+            const SecondOrderConeConstraint &constraint = problem.second_order_cone_constraints[i];
+            count_norm(constraint.norm);
+            num_cone_nonzeros += constraint.affine.terms.size();
+        }
+        auto count_rotated_cone = [&](const RotatedSecondOrderConeConstraint &constraint) {
+            count_norm(constraint.norm);
+            num_cone_rows++;
+            num_cone_nonzeros += 2 * (constraint.first_factor.terms.size() + constraint.second_factor.terms.size());
+        };
+        for (size_t i = num_rotated_cone_constraints; i < problem.rotated_second_order_cone_constraints.size(); i++)
+        {
+            count_rotated_cone(problem.rotated_second_order_cone_constraints[i]);
+        }
+        for (const RotatedSecondOrderConeConstraint &constraint : cost_cones)
+        {
+            count_rotated_cone(constraint);
+        }
+
+        A_coeffs.reserve(num_equality_nonzeros + A_params.nonZeros());
+        b_coeffs.reserve(num_equality_rows);
+        G_coeffs.reserve(num_linear_nonzeros);
+        h_coeffs.reserve(num_linear_rows);
+        G_cone_coeffs.reserve(num_cone_nonzeros);
+        h_cone_coeffs.reserve(num_cone_rows);
+        cone_dimensions.reserve(num_cones);
+
+        // New equality rows are appended to the existing ones
+        const size_t first_equality_row = A_params.rows();
+
+        // Adds the rotated cone as ||(2 * norm, u - v)|| <= u + v with clean expressions
+        auto rotate_cone = [](const RotatedSecondOrderConeConstraint &constraint, Affine &sum, std::vector<Affine> &rotated_norm) {
+            sum = constraint.first_factor;
+            sum += constraint.second_factor;
+            sum.cleanUp();
+
+            rotated_norm.reserve(constraint.norm.size() + 1);
+            rotated_norm.push_back(constraint.first_factor - constraint.second_factor);
+            for (const Affine &affine : constraint.norm)
+            {
+                rotated_norm.push_back(affine);
+                rotated_norm.back() *= Parameter(2.);
+            }
+            for (Affine &affine : rotated_norm)
+            {
+                affine.cleanUp();
+            }
+        };
+
+        // Clean up the expressions of the new constraints on multiple threads. Each constraint is
+        // processed exactly as in the loops below, which only number the variables and rows in order.
+        parallelFor(num_equality_constraints, problem.equality_constraints.size(), [&](size_t i) {
+            problem.equality_constraints[i].affine.cleanUp();
+        });
+        parallelFor(num_positive_constraints, problem.positive_constraints.size(), [&](size_t i) {
+            PositiveConstraint &constraint = problem.positive_constraints[i];
+            if (constraint.piecewise_linear.empty())
+            {
+                constraint.affine.cleanUp();
+            }
+        });
+        std::vector<std::pair<Affine, Affine>> box_rows(problem.box_constraints.size() - num_box_constraints);
+        parallelFor(num_box_constraints, problem.box_constraints.size(), [&](size_t i) {
+            // 0 <= middle - lower and 0 <= upper - middle
+            const BoxConstraint &constraint = problem.box_constraints[i];
+            auto &[middle_m_lower, upper_m_middle] = box_rows[i - num_box_constraints];
+            middle_m_lower = constraint.middle - constraint.lower;
+            middle_m_lower.cleanUp();
+            upper_m_middle = constraint.upper - constraint.middle;
+            upper_m_middle.cleanUp();
+        });
+        parallelFor(num_cone_constraints, problem.second_order_cone_constraints.size(), [&](size_t i) {
+            SecondOrderConeConstraint &constraint = problem.second_order_cone_constraints[i];
             constraint.affine.cleanUp();
+            for (Affine &affine : constraint.norm)
+            {
+                affine.cleanUp();
+            }
+        });
+        std::vector<std::pair<Affine, std::vector<Affine>>> rotated_cones(problem.rotated_second_order_cone_constraints.size() - num_rotated_cone_constraints);
+        parallelFor(num_rotated_cone_constraints, problem.rotated_second_order_cone_constraints.size(), [&](size_t i) {
+            auto &[sum, rotated_norm] = rotated_cones[i - num_rotated_cone_constraints];
+            rotate_cone(problem.rotated_second_order_cone_constraints[i], sum, rotated_norm);
+        });
+
+        // Build equality constraint parameters (b - A * x == 0)
+        for (size_t i = num_equality_constraints; i < problem.equality_constraints.size(); i++)
+        {
+            internal::EqualityConstraint &constraint = problem.equality_constraints[i];
             if (constraint.affine.isConstant())
             {
                 continue;
@@ -21,134 +154,578 @@ namespace cvx::internal
             for (Term &term : constraint.affine.terms)
             {
                 addVariable(term.variable);
-                A_coeffs.emplace_back(b_coeffs.size(),
+                A_coeffs.add(first_equality_row + b_coeffs.size(),
                                       term.variable.getProblemIndex(),
                                       term.parameter);
             }
 
+            addRowToBlocks(equality_rows, constraint.source, first_equality_row + b_coeffs.size(), Constraint::Equality, 1);
             b_coeffs.push_back(constraint.affine.constant);
         }
 
-        // Build positive constraint parameters
-        for (internal::PositiveConstraint &constraint : problem.positive_constraints)
-        {
-            constraint.affine.cleanUp();
-            if (constraint.affine.isConstant())
+        // Build positive constraint parameters from clean expressions
+        auto add_positive_row = [&](Affine &affine, const std::shared_ptr<ConstraintSource> &source, size_t num_rows) {
+            if (affine.isConstant())
             {
-                continue;
+                return;
             }
 
-            for (Term &term : constraint.affine.terms)
+            for (Term &term : affine.terms)
             {
                 addVariable(term.variable);
-                G_coeffs.emplace_back(h_coeffs.size(),
+                G_coeffs.add(h_coeffs.size(),
                                       term.variable.getProblemIndex(),
                                       term.parameter);
             }
 
-            h_coeffs.push_back(constraint.affine.constant);
+            addRowToBlocks(linear_rows, source, h_coeffs.size(), Constraint::Positive, num_rows);
+            h_coeffs.push_back(affine.constant);
+        };
+
+        auto add_positive_constraint = [&](PositiveConstraint &constraint) {
+            if (constraint.piecewise_linear.empty())
+            {
+                add_positive_row(constraint.affine, constraint.source, 1);
+                return;
+            }
+
+            // sum(slacks) <= affine with the rows of the slacks
+            std::vector<Affine> slack_rows;
+            Affine affine = constraint.affine - addSlacks(constraint.piecewise_linear, slack_rows);
+            affine.cleanUp();
+            add_positive_row(affine, constraint.source, slack_rows.size() + 1);
+            for (Affine &row : slack_rows)
+            {
+                row.cleanUp();
+                add_positive_row(row, constraint.source, slack_rows.size() + 1);
+            }
+        };
+
+        for (size_t i = num_positive_constraints; i < problem.positive_constraints.size(); i++)
+        {
+            add_positive_constraint(problem.positive_constraints[i]);
+        }
+
+        // Rows of slack variables in the cost function
+        for (PositiveConstraint &constraint : cost_rows)
+        {
+            if (constraint.piecewise_linear.empty())
+            {
+                constraint.affine.cleanUp();
+            }
+            add_positive_constraint(constraint);
         }
+        cost_rows.clear();
 
         // Build box constraint parameters
-        for (internal::BoxConstraint &constraint : problem.box_constraints)
+        for (size_t i = num_box_constraints; i < problem.box_constraints.size(); i++)
         {
+            internal::BoxConstraint &constraint = problem.box_constraints[i];
+            auto &[middle_m_lower, upper_m_middle] = box_rows[i - num_box_constraints];
+            const size_t num_rows = size_t(middle_m_lower.isFirstOrder()) + size_t(upper_m_middle.isFirstOrder());
+
             // lower <= middle <= upper
 
             // 0 <= middle - lower
-            Affine middle_m_lower = constraint.middle - constraint.lower;
-            middle_m_lower.cleanUp();
-
             if (middle_m_lower.isFirstOrder())
             {
                 for (Term &term : middle_m_lower.terms)
                 {
                     addVariable(term.variable);
-                    G_coeffs.emplace_back(h_coeffs.size(),
+                    G_coeffs.add(h_coeffs.size(),
                                           term.variable.getProblemIndex(),
                                           term.parameter);
                 }
+                addRowToBlocks(linear_rows, constraint.source, h_coeffs.size(), Constraint::Box, num_rows);
                 h_coeffs.push_back(middle_m_lower.constant);
             }
 
             // 0 <= upper - middle
-            Affine upper_m_middle = constraint.upper - constraint.middle;
-            upper_m_middle.cleanUp();
-
             if (upper_m_middle.isFirstOrder())
             {
                 for (Term &term : upper_m_middle.terms)
                 {
                     addVariable(term.variable);
-                    G_coeffs.emplace_back(h_coeffs.size(),
+                    G_coeffs.add(h_coeffs.size(),
                                           term.variable.getProblemIndex(),
                                           term.parameter);
                 }
+                addRowToBlocks(linear_rows, constraint.source, h_coeffs.size(), Constraint::Box, num_rows);
                 h_coeffs.push_back(upper_m_middle.constant);
             }
         }
 
+        // Adds the cone ||norm|| <= affine with clean expressions
+        auto add_cone = [&](Affine &affine,
+                            std::vector<Affine> &norm,
+                            const std::shared_ptr<ConstraintSource> &source,
+                            Constraint::Type type) {
+            const size_t num_rows = 1 + std::count_if(norm.begin(), norm.end(), [](const Affine &a) { return not a.isZero(); });
+
+            // Affine part
+            for (Term &term : affine.terms)
+            {
+                addVariable(term.variable);
+                G_cone_coeffs.add(h_cone_coeffs.size(),
+                                           term.variable.getProblemIndex(),
+                                           term.parameter);
+            }
+            addRowToBlocks(cone_rows, source, h_cone_coeffs.size(), type, num_rows);
+            h_cone_coeffs.push_back(affine.constant);
+
+            // Norm part
+            int cone_dimension = 1;
+            for (Affine &norm_affine : norm)
+            {
+                if (norm_affine.isZero())
+                {
+                    continue;
+                }
+
+                for (Term &term : norm_affine.terms)
+                {
+                    addVariable(term.variable);
+                    G_cone_coeffs.add(h_cone_coeffs.size(),
+                                               term.variable.getProblemIndex(),
+                                               term.parameter);
+                }
+                addRowToBlocks(cone_rows, source, h_cone_coeffs.size(), type, num_rows);
+                h_cone_coeffs.push_back(norm_affine.constant);
+                cone_dimension++;
+            }
+
+            cone_dimensions.push_back(cone_dimension);
+        };
+
         // Build second order cone constraint parameters
-        for (internal::SecondOrderConeConstraint &constraint : problem.second_order_cone_constraints)
+        for (size_t i = num_cone_constraints; i < problem.second_order_cone_constraints.size(); i++)
         {
-            // Affine part
-            constraint.affine.cleanUp();
+            internal::SecondOrderConeConstraint &constraint = problem.second_order_cone_constraints[i];
+            add_cone(constraint.affine, constraint.norm, constraint.source, Constraint::SecondOrderCone);
+        }
 
-            for (Term &term : constraint.affine.terms)
+        // Build rotated second order cone constraint parameters
+        for (size_t i = num_rotated_cone_constraints; i < problem.rotated_second_order_cone_constraints.size(); i++)
+        {
+            auto &[sum, rotated_norm] = rotated_cones[i - num_rotated_cone_constraints];
+            add_cone(sum, rotated_norm, problem.rotated_second_order_cone_constraints[i].source, Constraint::RotatedSecondOrderCone);
+        }
+
+        // Epigraphs of quadratic cost terms
+        for (RotatedSecondOrderConeConstraint &constraint : cost_cones)
+        {
+            Affine sum;
+            std::vector<Affine> rotated_norm;
+            rotate_cone(constraint, sum, rotated_norm);
+            add_cone(sum, rotated_norm, constraint.source, Constraint::RotatedSecondOrderCone);
+        }
+        cost_cones.clear();
+
+        num_equality_constraints = problem.equality_constraints.size();
+        num_positive_constraints = problem.positive_constraints.size();
+        num_box_constraints = problem.box_constraints.size();
+        num_cone_constraints = problem.second_order_cone_constraints.size();
+        num_rotated_cone_constraints = problem.rotated_second_order_cone_constraints.size();
+
+        if (b_coeffs.empty() and h_coeffs.empty() and h_cone_coeffs.empty())
+        {
+            return false;
+        }
+
+        // Equality rows: old rows followed by the new rows
+        A_params.appendTo(A_coeffs);
+
+        A_params.resize(first_equality_row + b_coeffs.size(), getNumVariables());
+        A_params.setFromCoefficients(A_coeffs);
+        b_params.conservativeResize(A_params.rows());
+        b_params.tail(b_coeffs.size()) = Eigen::Map<VectorXp>(b_coeffs.data(), b_coeffs.size());
+
+        // Inequality rows: old positive rows, new positive rows, old cone rows, new cone rows
+        const size_t n_pc_old = getNumPositiveConstraints();
+        const size_t n_pc_new = h_coeffs.size();
+        const size_t n_cone_rows_old = G_params.rows() - n_pc_old;
+        const size_t first_cone_row = n_pc_old + n_pc_new + n_cone_rows_old;
+
+        CoefficientList G_all_coeffs;
+        G_all_coeffs.reserve(G_params.nonZeros() + G_coeffs.size() + G_cone_coeffs.size());
+        for (size_t col = 0; col < G_params.cols(); col++)
+        {
+            for (int k = G_params.outerIndexPtr()[col]; k < G_params.outerIndexPtr()[col + 1]; k++)
+            {
+                const size_t old_row = G_params.innerIndexPtr()[k];
+                const size_t row = old_row < n_pc_old ? old_row : old_row + n_pc_new;
+                G_all_coeffs.add(row, col, G_params.values()[k]);
+            }
+        }
+        G_all_coeffs.append(G_coeffs, n_pc_old);
+        G_all_coeffs.append(G_cone_coeffs, first_cone_row);
+
+        G_params.resize(first_cone_row + h_cone_coeffs.size(), getNumVariables());
+        G_params.setFromCoefficients(G_all_coeffs);
+
+        VectorXp h_all(G_params.rows());
+        h_all << h_params.head(n_pc_old),
+            Eigen::Map<VectorXp>(h_coeffs.data(), h_coeffs.size()),
+            h_params.tail(n_cone_rows_old),
+            Eigen::Map<VectorXp>(h_cone_coeffs.data(), h_cone_coeffs.size());
+        h_params = h_all;
+
+        for (RowBlock &block : inequality_rows)
+        {
+            if (block.start >= n_pc_old)
+            {
+                block.start += n_pc_new;
+            }
+        }
+        for (RowBlock &block : linear_rows)
+        {
+            block.start += n_pc_old;
+            inequality_rows.push_back(block);
+        }
+        for (RowBlock &block : cone_rows)
+        {
+            block.start += first_cone_row;
+            inequality_rows.push_back(block);
+        }
+
+        soc_dims.conservativeResize(soc_dims.size() + cone_dimensions.size());
+        soc_dims.tail(cone_dimensions.size()) = Eigen::Map<Eigen::VectorXi>(cone_dimensions.data(), cone_dimensions.size());
+
+        c_params.conservativeResize(getNumVariables());
+        solution->resize(getNumVariables());
+
+        // The duals are ordered as equality rows followed by inequality rows
+        dual_rows = equality_rows;
+        for (RowBlock block : inequality_rows)
+        {
+            block.start += A_params.rows();
+            dual_rows.push_back(block);
+        }
+        num_dual_rows = A_params.rows() + G_params.rows();
+
+        return true;
+    }
+
+    void SOCPWrapperBase::addCost(Scalar &cost, const Parameter &weight, CoefficientList &c_coeffs)
+    {
+        cost.affine.cleanUp();
+        if (cost.isNorm())
+        {
+            throw std::runtime_error("SOCP cost functions must be linear or quadratic.");
+        }
+
+        // Linear part
+        for (Term &term : cost.affine.terms)
+        {
+            addVariable(term.variable);
+            c_coeffs.add(term.variable.getProblemIndex(), 0, weight * term.parameter);
+        }
+
+        // Piecewise linear part: weighted slacks in the cost, slack - a'x - b >= 0 in the constraints
+        if (not cost.piecewise_linear.empty())
+        {
+            checkPiecewiseLinearCost(cost.piecewise_linear);
+
+            std::vector<Affine> slack_rows;
+            Affine slacks = addSlacks(cost.piecewise_linear, slack_rows);
+            for (Term &term : slacks.terms)
             {
                 addVariable(term.variable);
-                G_coeffs.emplace_back(h_coeffs.size(),
-                                      term.variable.getProblemIndex(),
-                                      term.parameter);
+                c_coeffs.add(term.variable.getProblemIndex(), 0, weight * term.parameter);
             }
-            h_coeffs.push_back(constraint.affine.constant);
 
-            // Norm part
-            for (Affine &affine : constraint.norm)
+            const std::shared_ptr<ConstraintSource> source = std::make_shared<ConstraintSource>();
+            for (Affine &row : slack_rows)
             {
-                affine.cleanUp();
+                PositiveConstraint constraint;
+                constraint.affine = row;
+                constraint.source = source;
+                cost_rows.push_back(constraint);
+            }
+        }
 
-                if (affine.isZero())
+        if (cost.products.empty() and cost.quad_forms.empty())
+        {
+            return;
+        }
+
+        // Quadratic part: ||norm||^2 <= epigraph, with the epigraph variable in the cost
+        RotatedSecondOrderConeConstraint epigraph;
+
+        // Products that are not squares are collected in x' * M * x and factorized
+        std::map<size_t, size_t> local_indices;
+        std::vector<Variable> local_variables;
+        std::vector<Eigen::Triplet<double>> M_coeffs;
+
+        auto add_bilinear = [&](Term &term1, Term &term2, const Parameter &factor) {
+            const Parameter param = factor * term1.parameter * term2.parameter;
+            if (not param.isConstant())
+            {
+                throw std::runtime_error("Quadratic terms in SOCP cost functions that are not squares must have constant coefficients.");
+            }
+
+            size_t indices[2];
+            Variable *variables[2] = {&term1.variable, &term2.variable};
+            for (size_t k = 0; k < 2; k++)
+            {
+                addVariable(*variables[k]);
+                const auto [it, inserted] = local_indices.emplace(variables[k]->getProblemIndex(), local_variables.size());
+                if (inserted)
+                {
+                    local_variables.push_back(*variables[k]);
+                }
+                indices[k] = it->second;
+            }
+
+            // Symmetric, so diagonal elements get the full value
+            const double value = 0.5 * double(param);
+            M_coeffs.emplace_back(indices[0], indices[1], value);
+            M_coeffs.emplace_back(indices[1], indices[0], value);
+        };
+
+        auto add_linear = [&](Term &term, const Parameter &factor) {
+            addVariable(term.variable);
+            c_coeffs.add(term.variable.getProblemIndex(), 0, weight * factor * term.parameter);
+        };
+
+        for (Product &product : cost.products)
+        {
+            if (product.isSquare())
+            {
+                epigraph.norm.push_back(product.firstTerm());
+                continue;
+            }
+
+            Affine &first = product.firstTerm();
+            Affine &second = product.secondTerm();
+            for (Term &term1 : first.terms)
+            {
+                for (Term &term2 : second.terms)
+                {
+                    add_bilinear(term1, term2, Parameter(1.));
+                }
+            }
+
+            // The linear parts from the multiplication
+            if (not first.constant.isZero())
+            {
+                for (Term &term : second.terms)
+                {
+                    add_linear(term, first.constant);
+                }
+            }
+            if (not second.constant.isZero())
+            {
+                for (Term &term : first.terms)
+                {
+                    add_linear(term, second.constant);
+                }
+            }
+        }
+
+        for (QuadForm &quad_form : cost.quad_forms)
+        {
+            for (int k = 0; k < quad_form.Q.outerSize(); k++)
+            {
+                for (Eigen::SparseMatrix<Parameter>::InnerIterator it(quad_form.Q, k); it; ++it)
+                {
+                    Affine &x_i = quad_form.x[it.row()];
+                    Affine &x_j = quad_form.x[it.col()];
+
+                    // Off-diagonal elements appear twice in x' * Q * x
+                    const Parameter factor = it.value() * Parameter(it.row() == it.col() ? 1. : 2.);
+
+                    if (not x_i.terms.empty() and not x_j.terms.empty())
+                    {
+                        add_bilinear(x_i.terms.front(), x_j.terms.front(), factor);
+                    }
+
+                    // The linear parts from the constants
+                    if (not x_i.terms.empty() and not x_j.constant.isZero())
+                    {
+                        add_linear(x_i.terms.front(), factor * x_j.constant);
+                    }
+                    if (not x_j.terms.empty() and not x_i.constant.isZero())
+                    {
+                        add_linear(x_j.terms.front(), factor * x_i.constant);
+                    }
+                }
+            }
+        }
+
+        if (not local_variables.empty())
+        {
+            const size_t n = local_variables.size();
+            Eigen::SparseMatrix<double> M(n, n);
+            M.setFromTriplets(M_coeffs.begin(), M_coeffs.end());
+
+            // x' * M * x = ||sqrt(D) * L' * P * x||^2
+            const Eigen::LDLT<Eigen::MatrixXd> ldlt(M.toDense());
+            const Eigen::VectorXd D = ldlt.vectorD();
+            const double tolerance = 1e-12 * std::max(1., D.cwiseAbs().maxCoeff());
+            if (ldlt.info() != Eigen::Success or D.minCoeff() < -tolerance)
+            {
+                throw std::runtime_error("SOCP cost functions must be convex.");
+            }
+
+            Eigen::MatrixXd R = ldlt.transpositionsP() * Eigen::MatrixXd::Identity(n, n);
+            R = ldlt.matrixU() * R;
+
+            for (size_t row = 0; row < n; row++)
+            {
+                if (D(row) <= tolerance)
                 {
                     continue;
                 }
 
-                for (Term &term : affine.terms)
+                Affine affine;
+                for (size_t col = 0; col < n; col++)
                 {
-                    addVariable(term.variable);
-                    G_coeffs.emplace_back(h_coeffs.size(),
-                                          term.variable.getProblemIndex(),
-                                          term.parameter);
+                    const double value = std::sqrt(D(row)) * R(row, col);
+                    if (value != 0.)
+                    {
+                        Term term;
+                        term.parameter = Parameter(value);
+                        term.variable = local_variables[col];
+                        affine.terms.push_back(term);
+                    }
                 }
-                h_coeffs.push_back(affine.constant);
+                epigraph.norm.push_back(affine);
             }
+        }
 
-            cone_dimensions.push_back(constraint.norm.size() + 1);
+        if (epigraph.norm.empty())
+        {
+            return;
         }
 
+        Variable epigraph_variable("epigraph", cost_cones.size());
+        addVariable(epigraph_variable);
+        c_coeffs.add(epigraph_variable.getProblemIndex(), 0, weight);
+
+        Term epigraph_term;
+        epigraph_term.parameter = Parameter(1.);
+        epigraph_term.variable = epigraph_variable;
+        epigraph.first_factor.terms = {epigraph_term};
+        epigraph.second_factor = Affine(Parameter(1.));
+        epigraph.source = std::make_shared<ConstraintSource>();
+        cost_cones.push_back(epigraph);
+    }
+
+    SOCPWrapperBase::SOCPWrapperBase(OptimizationProblem &problem, bool presolve)
+        : problem(problem)
+    {
+        // Build constraint parameters
+        canonicalizeNewConstraints();
+
         // Build cost function
-        problem.costFunction.affine.cleanUp();
-        if (problem.costFunction.getOrder() != 1)
+        bool has_cost = problem.costFunction.getOrder() > 0;
+        for (const auto &[name, cost_slot] : problem.cost_slots)
+        {
+            has_cost |= cost_slot.cost.getOrder() > 0;
+        }
+        if (not has_cost)
         {
             throw std::runtime_error("SOCP cost functions must be linear.");
         }
 
-        for (Term &term : problem.costFunction.affine.terms)
+        // Counting pass: reserve the storage for the linear cost coefficients
+        size_t num_linear = 0;
+        size_t num_quadratic = 0;
+        countCost(problem.costFunction, num_linear, num_quadratic);
+        for (const auto &[name, cost_slot] : problem.cost_slots)
         {
-            addVariable(term.variable);
-            c_params(term.variable.getProblemIndex()) += term.parameter;
+            countCost(cost_slot.cost, num_linear, num_quadratic);
         }
+        CoefficientList c_coeffs;
+        c_coeffs.reserve(num_linear + problem.cost_slots.size() + 1);
+
+        addCost(problem.costFunction, Parameter(1.), c_coeffs);
+
+        // Cost slots are scaled with their dynamic weights
+        for (auto &[name, cost_slot] : problem.cost_slots)
+        {
+            addCost(cost_slot.cost, Parameter(&cost_slot.weight), c_coeffs);
+        }
+
+        // Epigraphs of the quadratic cost terms and rows of slack variables
+        if (not cost_cones.empty() or not cost_rows.empty())
+        {
+            canonicalizeNewConstraints();
+        }
+
+        cost_revision = problem.cost_revision;
 
-        // Fill matrices and vectors
-        A_params.resize(b_coeffs.size(), getNumVariables());
-        G_params.resize(h_coeffs.size(), getNumVariables());
+        // Variables that only appear in the cost function
+        A_params.conservativeResize(A_params.rows(), getNumVariables());
+        G_params.conservativeResize(G_params.rows(), getNumVariables());
 
-        A_params.setFromTriplets(A_coeffs.begin(), A_coeffs.end());
-        G_params.setFromTriplets(G_coeffs.begin(), G_coeffs.end());
-        b_params = Eigen::Map<VectorXp>(b_coeffs.data(), b_coeffs.size());
-        h_params = Eigen::Map<VectorXp>(h_coeffs.data(), h_coeffs.size());
-        soc_dims = Eigen::Map<Eigen::VectorXi>(cone_dimensions.data(), cone_dimensions.size());
+        // Fill the cost vector, all variables are known at this point
+        c_params.conservativeResize(getNumVariables());
+        addCoefficients(c_coeffs, c_params);
 
         solution->resize(getNumVariables());
+
+        if (presolve)
+        {
+            presolveProblem();
+        }
+    }
+
+    void SOCPWrapperBase::presolveProblem()
+    {
+        // Rows in the form lower <= a'x: equality rows, positive rows and cone rows
+        const size_t n_eq = getNumEqualityConstraints();
+        const size_t n_pc = getNumPositiveConstraints();
+        const size_t n_ineq = getNumInequalityConstraints();
+
+        CoefficientList coeffs;
+        coeffs.reserve(A_params.nonZeros() + G_params.nonZeros());
+        A_params.appendTo(coeffs);
+        G_params.appendTo(coeffs, n_eq);
+        ParameterMatrix rows(n_eq + n_ineq, getNumVariables());
+        rows.setFromCoefficients(coeffs);
+
+        VectorXp lower(n_eq + n_ineq);
+        lower << -b_params, -h_params;
+        VectorXp upper = lower;
+        upper.segment(n_eq, n_pc).setConstant(Parameter(std::numeric_limits<double>::max()));
+
+        std::vector<Presolve::RowType> row_types(n_eq + n_ineq, Presolve::RowType::Cone);
+        std::fill_n(row_types.begin(), n_eq, Presolve::RowType::Equality);
+        std::fill_n(row_types.begin() + n_eq, n_pc, Presolve::RowType::Inequality);
+
+        const ParameterMatrix P(getNumVariables(), getNumVariables());
+        presolve = std::make_unique<Presolve>(rows, lower, upper, row_types, P, c_params);
+
+        // Cone rows are never removed, so the cone dimensions stay the same
+        const size_t n_eq_reduced = presolve->getNumReducedRows(Presolve::RowType::Equality);
+        const size_t n_ineq_reduced = presolve->getNumReducedRows() - n_eq_reduced;
+        A_params = presolve->getReducedMatrix(0, n_eq_reduced);
+        b_params = -presolve->getReducedLower(0, n_eq_reduced);
+        G_params = presolve->getReducedMatrix(n_eq_reduced, n_ineq_reduced);
+        h_params = -presolve->getReducedLower(n_eq_reduced, n_ineq_reduced);
+        c_params = presolve->getReducedLinearCost();
+
+        reduceRowBlocks(equality_rows, 0, 0);
+        reduceRowBlocks(inequality_rows, n_eq, n_eq_reduced);
+    }
+
+    void SOCPWrapperBase::addNewConstraints()
+    {
+        if (problem.cost_revision != cost_revision)
+        {
+            throw std::runtime_error("The cost function has been changed after creating the solver. Create a new solver instead.");
+        }
+        if (presolve)
+        {
+            throw std::runtime_error("Constraints can not be added to a presolved problem. Create a new solver instead.");
+        }
+
+        if (canonicalizeNewConstraints())
+        {
+            rebuildWorkspace();
+        }
     }
 
     void SOCPWrapperBase::addVariable(Variable &variable)
@@ -157,7 +734,6 @@ namespace cvx::internal
         if (was_linked)
         {
             variables.push_back(variable);
-            c_params.conservativeResize(getNumVariables());
         }
     }
 
@@ -181,6 +757,100 @@ namespace cvx::internal
         return soc_dims.size();
     }
 
+    bool SOCPWrapperBase::relaxDisabledRows(Eigen::Ref<Eigen::VectorXd> G_values, Eigen::Ref<Eigen::VectorXd> h,
+                                            Eigen::Ref<Eigen::VectorXd> A_values, Eigen::Ref<Eigen::VectorXd> b) const
+    {
+        checkPresolvedRows();
+
+        // Only allocated if a constraint is disabled. This is not a member, so isFeasible() can run
+        // while prepareUpdate() evaluates the data on another thread.
+        std::vector<bool> disabled_rows;
+
+        // Equality constraints: 0 == 0
+        bool any_equality_disabled = false;
+        for (const RowBlock &block : equality_rows)
+        {
+            if (not block.source->enabled)
+            {
+                if (not any_equality_disabled)
+                {
+                    disabled_rows.assign(b.size(), false);
+                    any_equality_disabled = true;
+                }
+                std::fill_n(disabled_rows.begin() + block.start, block.size, true);
+            }
+        }
+
+        if (any_equality_disabled)
+        {
+            for (Eigen::Index row = 0; row < b.size(); row++)
+            {
+                if (disabled_rows[row])
+                {
+                    b(row) = 0.;
+                }
+            }
+            for (size_t i = 0; i < A_params.nonZeros(); i++)
+            {
+                if (disabled_rows[A_params.innerIndexPtr()[i]])
+                {
+                    A_values(i) = 0.;
+                }
+            }
+        }
+
+        bool any_disabled = false;
+        for (const RowBlock &block : inequality_rows)
+        {
+            if (not block.source->enabled)
+            {
+                if (not any_disabled)
+                {
+                    disabled_rows.assign(h.size(), false);
+                    any_disabled = true;
+                }
+                std::fill_n(disabled_rows.begin() + block.start, block.size, true);
+            }
+        }
+
+        if (not any_disabled)
+        {
+            return any_equality_disabled;
+        }
+
+        // Positive constraints: 0 <= 1
+        const size_t n_pc = getNumPositiveConstraints();
+        for (size_t row = 0; row < n_pc; row++)
+        {
+            if (disabled_rows[row])
+            {
+                h(row) = 1.;
+            }
+        }
+
+        // Cones: ||0|| <= 1
+        size_t k = n_pc;
+        for (int i = 0; i < soc_dims.size(); i++)
+        {
+            if (disabled_rows[k])
+            {
+                h(k) = 1.;
+                h.segment(k + 1, soc_dims[i] - 1).setZero();
+            }
+            k += soc_dims[i];
+        }
+
+        for (size_t i = 0; i < G_params.nonZeros(); i++)
+        {
+            if (disabled_rows[G_params.innerIndexPtr()[i]])
+            {
+                G_values(i) = 0.;
+            }
+        }
+
+        return true;
+    }
+
     std::ostream &operator<<(std::ostream &os, const SOCPWrapperBase &wrapper)
     {
         Eigen::VectorXd c = eval(wrapper.c_params);
@@ -211,18 +881,23 @@ namespace cvx::internal
 
     bool SOCPWrapperBase::isFeasible(double tolerance) const
     {
-        Eigen::MatrixXd G = eval(G_params);
+        Eigen::SparseMatrix<double> G_sparse = eval(G_params);
         Eigen::VectorXd h = eval(h_params);
-        Eigen::MatrixXd A = -eval(A_params);
+        Eigen::SparseMatrix<double> A_sparse = eval(A_params);
         Eigen::VectorXd b = eval(b_params);
-        Eigen::VectorXd x = Eigen::Map<Eigen::VectorXd>((*solution).data(), (*solution).size());
-
-        if ((A * x - b).cwiseAbs().maxCoeff() > tolerance)
+        relaxDisabledRows(Eigen::Map<Eigen::VectorXd>(G_sparse.valuePtr(), G_sparse.nonZeros()), h,
+                          Eigen::Map<Eigen::VectorXd>(A_sparse.valuePtr(), A_sparse.nonZeros()), b);
+        Eigen::MatrixXd G = G_sparse;
+        Eigen::MatrixXd A = -Eigen::MatrixXd(A_sparse);
+        const Eigen::VectorXd x = presolve ? presolve->reducePrimal(*solution)
+                                           : Eigen::Map<Eigen::VectorXd>((*solution).data(), (*solution).size()).eval();
+
+        if (A.rows() > 0 and (A * x - b).cwiseAbs().maxCoeff() > tolerance)
         {
             return false;
         }
 
-        const size_t n_var = this->getNumVariables();
+        const size_t n_var = this->getNumSolverVariables();
         const size_t n_pc = this->getNumPositiveConstraints();
         const size_t n_cones = this->getNumCones();
 
@@ -1,5 +1,8 @@
 #include "wrappers/wrapperBase.hpp"
 
+#include <algorithm>
+#include <thread>
+
 namespace cvx::internal
 {
 
@@ -8,6 +11,480 @@ namespace cvx::internal
         return variables.size();
     }
 
+    void WrapperBase::addRowToBlocks(std::vector<RowBlock> &blocks,
+                                     const std::shared_ptr<ConstraintSource> &source,
+                                     size_t row,
+                                     Constraint::Type type,
+                                     size_t constraint_rows)
+    {
+        if (not blocks.empty() and
+            blocks.back().source == source and
+            blocks.back().start + blocks.back().size == row and
+            blocks.back().type == type and
+            blocks.back().constraint_rows == constraint_rows)
+        {
+            blocks.back().size++;
+        }
+        else
+        {
+            blocks.push_back({source, row, 1, type, constraint_rows});
+        }
+    }
+
+    void WrapperBase::addCoefficients(CoefficientList &coeffs, VectorXp &vector)
+    {
+        ParameterMatrix column(vector.size(), 1);
+        column.setFromCoefficients(coeffs);
+        for (size_t k = 0; k < column.nonZeros(); k++)
+        {
+            vector(column.innerIndexPtr()[k]) += column.values()[k];
+        }
+    }
+
+    Affine WrapperBase::addSlacks(const std::vector<PiecewiseLinear> &piecewise_linear, std::vector<Affine> &rows)
+    {
+        Affine sum;
+
+        for (const PiecewiseLinear &term : piecewise_linear)
+        {
+            auto add_slack = [&]() {
+                const Variable slack("slack", num_slacks++);
+                Term weighted_slack = slack;
+                weighted_slack.parameter = term.weight;
+                sum.terms.push_back(weighted_slack);
+                return Affine(Term(slack));
+            };
+
+            if (term.type == PiecewiseLinear::Type::Max)
+            {
+                // slack >= a_i
+                const Affine slack = add_slack();
+                for (const Affine &affine : term.terms)
+                {
+                    rows.push_back(slack - affine);
+                }
+            }
+            else
+            {
+                // slack_i >= |a_i|
+                for (const Affine &affine : term.terms)
+                {
+                    const Affine slack = add_slack();
+                    rows.push_back(slack - affine);
+                    rows.push_back(slack);
+                    rows.back() += affine;
+                }
+            }
+        }
+
+        return sum;
+    }
+
+    void WrapperBase::countSlacks(const std::vector<PiecewiseLinear> &piecewise_linear, size_t &num_rows, size_t &num_nonzeros)
+    {
+        for (const PiecewiseLinear &term : piecewise_linear)
+        {
+            const size_t rows_per_term = term.type == PiecewiseLinear::Type::Max ? 1 : 2;
+            num_nonzeros += term.type == PiecewiseLinear::Type::Max ? 1 : term.terms.size();
+            for (const Affine &affine : term.terms)
+            {
+                num_rows += rows_per_term;
+                num_nonzeros += rows_per_term * (affine.terms.size() + 1);
+            }
+        }
+    }
+
+    void WrapperBase::countCost(const Scalar &cost, size_t &num_linear, size_t &num_quadratic)
+    {
+        num_linear += cost.affine.terms.size();
+        for (const PiecewiseLinear &piecewise_linear : cost.piecewise_linear)
+        {
+            num_linear += piecewise_linear.type == PiecewiseLinear::Type::Max ? 1 : piecewise_linear.terms.size();
+        }
+        for (const Product &product : cost.products)
+        {
+            const size_t first_size = product.firstTerm().terms.size();
+            const size_t second_size = product.secondTerm().terms.size();
+            num_linear += first_size + second_size;
+            num_quadratic += first_size * second_size;
+        }
+        for (const QuadForm &quad_form : cost.quad_forms)
+        {
+            num_linear += 2 * quad_form.Q.nonZeros();
+            num_quadratic += quad_form.Q.nonZeros();
+        }
+    }
+
+    void WrapperBase::checkPiecewiseLinearCost(const std::vector<PiecewiseLinear> &piecewise_linear)
+    {
+        for (const PiecewiseLinear &term : piecewise_linear)
+        {
+            if (term.weight.isConstant() and term.weight.getValue() < 0.)
+            {
+                throw std::runtime_error("Piecewise linear terms in cost functions must have a nonnegative weight.");
+            }
+        }
+    }
+
+    size_t WrapperBase::getNumSolverVariables() const
+    {
+        return presolve ? presolve->getNumReducedColumns() : getNumVariables();
+    }
+
+    void WrapperBase::reduceRowBlocks(std::vector<RowBlock> &blocks, size_t row_offset, size_t reduced_offset)
+    {
+        std::vector<RowBlock> reduced_blocks;
+        for (const RowBlock &block : blocks)
+        {
+            for (size_t row = row_offset + block.start; row < row_offset + block.start + block.size; row++)
+            {
+                switch (presolve->getRowStatus(row))
+                {
+                case Presolve::RowStatus::Kept:
+                    addRowToBlocks(reduced_blocks, block.source, presolve->getReducedRow(row) - reduced_offset, block.type, block.constraint_rows);
+                    break;
+                case Presolve::RowStatus::Merged:
+                case Presolve::RowStatus::Fixing:
+                    addRowToBlocks(presolved_rows, block.source, row, block.type, block.constraint_rows);
+                    break;
+                case Presolve::RowStatus::Removed:
+                    break;
+                }
+            }
+        }
+        blocks = reduced_blocks;
+    }
+
+    void WrapperBase::checkPresolvedRows() const
+    {
+        for (const RowBlock &block : presolved_rows)
+        {
+            if (not block.source->enabled)
+            {
+                throw std::runtime_error("Constraints that have been merged or removed by the presolve can not be disabled.");
+            }
+        }
+    }
+
+    std::future<bool> WrapperBase::solveAsync(const CancellationToken &token, const Executor &executor)
+    {
+        // Take the prepared data now, so a prepareUpdate() before the solve starts prepares the next solve
+        {
+            std::lock_guard<std::mutex> lock(update_mutex);
+            if (takePreparedUpdate())
+            {
+                update_claimed = true;
+            }
+        }
+
+        // A packaged task can not be copied into a std::function
+        auto task = std::make_shared<std::packaged_task<bool()>>([this, token]() { return solve(token); });
+        std::future<bool> result = task->get_future();
+
+        if (executor)
+        {
+            executor([task]() { (*task)(); });
+        }
+        else
+        {
+            std::thread([task]() { (*task)(); }).detach();
+        }
+
+        return result;
+    }
+
+    bool WrapperBase::wasCancelled() const
+    {
+        return cancelled;
+    }
+
+    void WrapperBase::prepareUpdate()
+    {
+        std::lock_guard<std::mutex> lock(update_mutex);
+
+        evaluatePreparedUpdate();
+        update_prepared = true;
+    }
+
+    std::future<void> WrapperBase::prepareUpdateAsync(const Executor &executor)
+    {
+        auto task = std::make_shared<std::packaged_task<void()>>([this]() { prepareUpdate(); });
+        std::future<void> result = task->get_future();
+
+        if (executor)
+        {
+            executor([task]() { (*task)(); });
+        }
+        else
+        {
+            std::thread([task]() { (*task)(); }).detach();
+        }
+
+        return result;
+    }
+
+    bool WrapperBase::takePreparedUpdate()
+    {
+        if (update_claimed)
+        {
+            update_claimed = false;
+            return true;
+        }
+        if (not update_prepared)
+        {
+            return false;
+        }
+
+        swapUpdateBuffers();
+        update_prepared = false;
+        return true;
+    }
+
+    void WrapperBase::discardPreparedUpdate()
+    {
+        update_prepared = false;
+        update_claimed = false;
+    }
+
+    void WrapperBase::getDualValue(const ConstraintHandle &handle, Eigen::VectorXd &duals) const
+    {
+        size_t num_rows = 0;
+        for (const RowBlock &block : dual_rows)
+        {
+            if (block.source == handle.source)
+            {
+                num_rows += block.size;
+            }
+        }
+
+        if (num_rows == 0)
+        {
+            throw std::runtime_error("The constraint handle does not belong to this solver.");
+        }
+        if (size_t(dual_solution.size()) != num_dual_rows)
+        {
+            throw std::runtime_error("There is no dual solution. Solve the problem first.");
+        }
+
+        if (size_t(duals.size()) != num_rows)
+        {
+            duals.resize(num_rows);
+        }
+        size_t k = 0;
+        for (const RowBlock &block : dual_rows)
+        {
+            if (block.source == handle.source)
+            {
+                duals.segment(k, block.size) = dual_solution.segment(block.start, block.size);
+                k += block.size;
+            }
+        }
+    }
+
+    void WrapperBase::setPrimalGuess(const MatrixX &block, const Eigen::MatrixXd &values)
+    {
+        if (block.rows() != values.rows() or block.cols() != values.cols())
+        {
+            throw std::runtime_error("The size of the warm start values does not match the variables.");
+        }
+
+        // Constraints with new variables may have been added since the last guess
+        if (primal_guess.size() != solution->size())
+        {
+            primal_guess = *solution;
+        }
+
+        for (int row = 0; row < block.rows(); row++)
+        {
+            for (int col = 0; col < block.cols(); col++)
+            {
+                size_t index;
+                if (getGuessIndex(block(row, col), index))
+                {
+                    primal_guess[index] = values(row, col);
+                }
+            }
+        }
+    }
+
+    void WrapperBase::shiftPrimalGuess(const MatrixX &block)
+    {
+        if (primal_guess.size() != solution->size())
+        {
+            primal_guess = *solution;
+        }
+
+        // Ascending columns read the next column before it is overwritten
+        for (int col = 0; col + 1 < block.cols(); col++)
+        {
+            for (int row = 0; row < block.rows(); row++)
+            {
+                size_t index, next_index;
+                if (getGuessIndex(block(row, col), index) and getGuessIndex(block(row, col + 1), next_index))
+                {
+                    primal_guess[index] = primal_guess[next_index];
+                }
+            }
+        }
+    }
+
+    void WrapperBase::shiftDualGuess(const ConstraintHandle &handle, size_t num_stages)
+    {
+        std::vector<size_t> rows;
+        const RowBlock *first_block = nullptr;
+        bool uniform = true;
+        for (const RowBlock &block : dual_rows)
+        {
+            if (block.source == handle.source)
+            {
+                if (first_block == nullptr)
+                {
+                    first_block = &block;
+                }
+                uniform = uniform and block.type == first_block->type and
+                          block.constraint_rows == first_block->constraint_rows;
+
+                for (size_t row = block.start; row < block.start + block.size; row++)
+                {
+                    rows.push_back(row);
+                }
+            }
+        }
+
+        if (rows.empty())
+        {
+            throw std::runtime_error("The constraint handle does not belong to this solver.");
+        }
+
+        // Every constraint must have created the same number of rows, otherwise the stages can not be found
+        const size_t num_constraints = handle.source->num_constraints;
+        const size_t constraint_rows = first_block->constraint_rows;
+        if (not uniform or rows.size() != num_constraints * constraint_rows)
+        {
+            throw std::runtime_error("The constraint handle has to consist of constraints of the same type with the same number of rows.");
+        }
+        if (num_stages == 0 or num_constraints % num_stages != 0)
+        {
+            throw std::runtime_error("The number of constraints of the handle is not a multiple of the number of stages.");
+        }
+
+        if (size_t(dual_guess.size()) != num_dual_rows)
+        {
+            dual_guess = size_t(dual_solution.size()) == num_dual_rows ? dual_solution : Eigen::VectorXd::Zero(num_dual_rows);
+        }
+
+        for (size_t first = 0; first < num_constraints; first += num_stages)
+        {
+            for (size_t stage = 0; stage + 1 < num_stages; stage++)
+            {
+                for (size_t row = 0; row < constraint_rows; row++)
+                {
+                    dual_guess(rows[(first + stage) * constraint_rows + row]) =
+                        dual_guess(rows[(first + stage + 1) * constraint_rows + row]);
+                }
+            }
+        }
+    }
+
+    bool WrapperBase::getGuessIndex(const Scalar &entry, size_t &index) const
+    {
+        const Affine &affine = entry.affine;
+        if (entry.getOrder() != 1 or affine.terms.size() != 1 or
+            not affine.constant.isZero() or not affine.terms.front().parameter.isOne())
+        {
+            return false;
+        }
+
+        const Variable &variable = affine.terms.front().variable;
+        if (not variable.isLinkedToSolver())
+        {
+            return false;
+        }
+        index = variable.getProblemIndex();
+        return index < variables.size() and variables[index] == variable;
+    }
+
+    void WrapperBase::setDualGuess(const ConstraintHandle &handle, const Eigen::VectorXd &values)
+    {
+        size_t num_rows = 0;
+        for (const RowBlock &block : dual_rows)
+        {
+            if (block.source == handle.source)
+            {
+                num_rows += block.size;
+            }
+        }
+
+        if (num_rows == 0)
+        {
+            throw std::runtime_error("The constraint handle does not belong to this solver.");
+        }
+        if (num_rows != size_t(values.size()))
+        {
+            throw std::runtime_error("The number of warm start values does not match the rows of the constraint handle.");
+        }
+
+        if (size_t(dual_guess.size()) != num_dual_rows)
+        {
+            dual_guess = size_t(dual_solution.size()) == num_dual_rows ? dual_solution : Eigen::VectorXd::Zero(num_dual_rows);
+        }
+
+        size_t k = 0;
+        for (const RowBlock &block : dual_rows)
+        {
+            if (block.source == handle.source)
+            {
+                dual_guess.segment(block.start, block.size) = values.segment(k, block.size);
+                k += block.size;
+            }
+        }
+    }
+
+    Eigen::VectorXd WrapperBase::getSolverPrimalGuess() const
+    {
+        const std::vector<double> &x = primal_guess.size() == solution->size() ? primal_guess : *solution;
+        return presolve ? presolve->reducePrimal(x)
+                        : Eigen::Map<const Eigen::VectorXd>(x.data(), x.size()).eval();
+    }
+
+    Eigen::VectorXd WrapperBase::getSolverDualGuess() const
+    {
+        Eigen::VectorXd y = dual_guess;
+        if (size_t(y.size()) != num_dual_rows)
+        {
+            y = size_t(dual_solution.size()) == num_dual_rows ? dual_solution : Eigen::VectorXd::Zero(num_dual_rows);
+        }
+        return presolve ? presolve->reduceDual(y) : y;
+    }
+
+    void WrapperBase::setSolution(const double *x)
+    {
+        primal_guess.clear();
+
+        if (presolve)
+        {
+            presolve->postsolvePrimal(x, *solution);
+        }
+        else
+        {
+            std::copy_n(x, getNumVariables(), solution->begin());
+        }
+    }
+
+    void WrapperBase::setDualSolution(const Eigen::Ref<const Eigen::VectorXd> &y, double sign)
+    {
+        dual_guess.resize(0);
+
+        if (presolve)
+        {
+            presolve->postsolveDual(*solution, y.data(), sign, dual_solution);
+        }
+        else
+        {
+            dual_solution = y;
+        }
+    }
+
     WrapperBase::~WrapperBase()
     {
         for (Variable &var : variables)
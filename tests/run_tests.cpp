@@ -25,3 +25,17 @@
 
 #include "test_simple_qp.hpp"
 #include "test_simple_socp.hpp"
+
+#include "test_incremental.hpp"
+#include "test_cost_slots.hpp"
+#include "test_presolve.hpp"
+#include "test_piecewise_linear.hpp"
+#include "test_operators.hpp"
+#include "test_warm_start.hpp"
+#include "test_horizon.hpp"
+#include "test_duals.hpp"
+#include "test_async.hpp"
+#include "test_batch.hpp"
+#include "test_parallel.hpp"
+#include "test_builder.hpp"
+#include "test_prepared_update.hpp"
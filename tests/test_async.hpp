@@ -0,0 +1,116 @@
+using namespace cvx;
+
+TEST_CASE("Asynchronous solve")
+{
+    OptimizationProblem qp;
+    VectorX x = qp.addVariable("x", 3);
+    qp.addConstraint(lessThan(x, 1.));
+    qp.addConstraint(equalTo(x.sum(), 2.));
+    qp.addCostTerm(x.squaredNorm() - 4. * x(0));
+
+    const Eigen::Vector3d expected(1., 0.5, 0.5);
+
+    SECTION("Default executor")
+    {
+        osqp::OSQPSolver solver(qp);
+        std::future<bool> result = solver.solveAsync();
+        REQUIRE(result.get());
+        REQUIRE_FALSE(solver.wasCancelled());
+        REQUIRE((eval(x) - expected).cwiseAbs().maxCoeff() < 1e-2);
+    }
+
+    SECTION("Chunked iterations")
+    {
+        osqp::OSQPSolver solver(qp);
+        solver.setMaxIter(2000);
+        REQUIRE(solver.solve(CancellationToken()));
+        REQUIRE(solver.getInfo().status_val == OSQP_SOLVED);
+        REQUIRE(solver.getInfo().iter > 0);
+        REQUIRE((eval(x) - expected).cwiseAbs().maxCoeff() < 1e-2);
+    }
+
+    SECTION("Token that can not be cancelled")
+    {
+        c_int iterations;
+        {
+            osqp::OSQPSolver solver(qp);
+            REQUIRE(solver.solve(false));
+            iterations = solver.getInfo().iter;
+        }
+
+        // The default token runs the same solve as solve(bool)
+        osqp::OSQPSolver async_solver(qp);
+        REQUIRE(async_solver.solveAsync().get());
+        REQUIRE(async_solver.getInfo().iter == iterations);
+
+        CancellationToken token = CancellationToken::none();
+        REQUIRE_FALSE(token.canBeCancelled());
+        REQUIRE_FALSE(token.isCancelled());
+        REQUIRE_THROWS(token.cancel());
+    }
+
+    SECTION("Custom executor")
+    {
+        osqp::OSQPSolver solver(qp);
+        size_t num_jobs = 0;
+        Executor inline_executor = [&](std::function<void()> job) {
+            num_jobs++;
+            job();
+        };
+
+        std::future<bool> result = solver.solveAsync(CancellationToken(), inline_executor);
+        REQUIRE(num_jobs == 1);
+        REQUIRE(result.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+        REQUIRE(result.get());
+    }
+
+    SECTION("Cancelled")
+    {
+        CancellationToken token;
+        CancellationToken copy = token;
+        copy.cancel();
+        REQUIRE(token.isCancelled());
+
+        {
+            osqp::OSQPSolver osqp_solver(qp);
+            REQUIRE_FALSE(osqp_solver.solveAsync(token).get());
+            REQUIRE(osqp_solver.wasCancelled());
+            REQUIRE(osqp_solver.getResultString() == "Solve cancelled.");
+
+            REQUIRE(osqp_solver.solve(false));
+            REQUIRE_FALSE(osqp_solver.wasCancelled());
+        }
+
+        ecos::ECOSSolver ecos_solver(qp);
+        REQUIRE_FALSE(ecos_solver.solveAsync(token).get());
+        REQUIRE(ecos_solver.wasCancelled());
+        REQUIRE(ecos_solver.getExitCode() == ECOS_SIGINT);
+
+        REQUIRE(ecos_solver.solveAsync().get());
+        REQUIRE_FALSE(ecos_solver.wasCancelled());
+        REQUIRE((eval(x) - expected).cwiseAbs().maxCoeff() < 1e-2);
+    }
+
+    SECTION("Cancelled during the solve")
+    {
+        // An infeasible problem does not converge, so the solve only ends when it is cancelled
+        OptimizationProblem infeasible;
+        Scalar y = infeasible.addVariable("y");
+        infeasible.addConstraint(lessThan(y, 0.));
+        infeasible.addConstraint(greaterThan(y, 1.));
+        infeasible.addCostTerm(y * y);
+
+        osqp::OSQPSolver solver(infeasible);
+        solver.setMaxIter(100000000);
+
+        CancellationToken token;
+        std::future<bool> result = solver.solveAsync(token);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        token.cancel();
+
+        REQUIRE_FALSE(result.get());
+        REQUIRE(solver.wasCancelled());
+        REQUIRE(solver.getInfo().iter > 0);
+        REQUIRE(solver.getInfo().iter < 100000000);
+    }
+}
@@ -0,0 +1,53 @@
+using namespace cvx;
+
+TEST_CASE("Batch solve")
+{
+    for (bool presolve : {false, true})
+    {
+        double a = 0.;
+        double b = 0.;
+
+        OptimizationProblem qp;
+        VectorX x = qp.addVariable("x", 2);
+        Scalar y = qp.addVariable("y");
+        qp.addConstraint(lessThan(x, 1.));
+        qp.addConstraint(equalTo(y, dynpar(a)));
+        qp.addCostTerm(square(x(0) - dynpar(a)) + square(x(1) - dynpar(b)) + square(y - x(0)));
+
+        osqp::BatchSolver batch(qp, {&a, &b}, presolve);
+
+        const size_t num_instances = 20;
+        const Eigen::MatrixXd values = 2. * Eigen::MatrixXd::Random(2, num_instances);
+
+        batch.solve(values, 3);
+        REQUIRE(batch.getNumInstances() == num_instances);
+        REQUIRE(batch.getSolutions().rows() == int(num_instances));
+        REQUIRE((batch.getStatus().array() == OSQP_SOLVED).all());
+        REQUIRE((batch.getIterations().array() > 0).all());
+
+        // With y = a the optimal x is the parameters clamped to 1
+        const Eigen::VectorXd expected_x0 = values.row(0).transpose().cwiseMin(1.);
+        const Eigen::VectorXd expected_x1 = values.row(1).transpose().cwiseMin(1.);
+        REQUIRE((batch.getValues(x(0)) - expected_x0).cwiseAbs().maxCoeff() < 1e-2);
+        REQUIRE((batch.getValues(x(1)) - expected_x1).cwiseAbs().maxCoeff() < 1e-2);
+        REQUIRE((batch.getValues(y) - values.row(0).transpose()).cwiseAbs().maxCoeff() < 1e-2);
+
+        // The parameters keep their values
+        REQUIRE(a == 0.);
+        REQUIRE(b == 0.);
+
+        // The same results with a single thread
+        const Eigen::MatrixXd solutions = batch.getSolutions();
+        batch.solve(values, 1);
+        REQUIRE((batch.getSolutions() - solutions).cwiseAbs().maxCoeff() < 1e-2);
+
+        // The solver can still be used on its own
+        a = 0.5;
+        b = 2.;
+        batch.getSolver().solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(0.5, 1.)).cwiseAbs().maxCoeff() < 1e-2);
+
+        REQUIRE_THROWS(batch.solve(Eigen::MatrixXd::Zero(3, 2)));
+        REQUIRE_THROWS(batch.getValues(2. * y));
+    }
+}
@@ -0,0 +1,60 @@
+#include <thread>
+
+using namespace cvx;
+
+TEST_CASE("Problem builder")
+{
+    const size_t n = 400;
+    const size_t num_threads = 4;
+    const Eigen::VectorXd b = Eigen::VectorXd::Random(n);
+
+    OptimizationProblem qp;
+    ProblemBuilder builder(qp);
+    VectorX x = builder.addVariable("x", n);
+
+    // Every thread adds its share of the constraints and cost terms and one variable
+    std::vector<ConstraintHandle> handles(num_threads);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; t++)
+    {
+        threads.emplace_back([&, t]() {
+            std::vector<Constraint> constraints;
+            for (size_t i = t; i < n; i += num_threads)
+            {
+                constraints.push_back(lessThan(x(i), par(b(i))));
+                builder.addCostTerm(square(x(i) - 1.));
+            }
+            handles[t] = builder.addConstraint(constraints);
+            builder.addVariable("y" + std::to_string(t));
+        });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE_THROWS(builder.addVariable("y0"));
+
+    builder.commit();
+    builder.commit();
+
+    osqp::OSQPSolver solver(qp);
+    solver.setEpsAbs(1e-5);
+    solver.setEpsRel(1e-5);
+    REQUIRE(solver.solve());
+    REQUIRE(solver.getNumVariables() == n);
+
+    Eigen::VectorXd x_eval;
+    qp.getVariableValue("x", x_eval);
+    REQUIRE(x_eval.isApprox(b.cwiseMin(1.), 1e-3));
+
+    // The handles refer to the constraints of their thread
+    handles[0].disable();
+    REQUIRE(solver.solve());
+    qp.getVariableValue("x", x_eval);
+    for (size_t i = 0; i < n; i++)
+    {
+        const double expected = i % num_threads == 0 ? 1. : std::min(b(i), 1.);
+        REQUIRE(x_eval(i) == Approx(expected).margin(1e-3));
+    }
+}
@@ -23,6 +23,14 @@ TEST_CASE("Constraint")
         test_stream << lessThan(x.norm(), 1.);
         REQUIRE(test_stream.str() == "((x[0])^2 + (x[1])^2)^(1/2) <= 1");
 
+        test_stream = std::ostringstream();
+        test_stream << lessThan(norm2(x), 1.);
+        REQUIRE(test_stream.str() == "((x[0])^2 + (x[1])^2)^(1/2) <= 1");
+
+        test_stream = std::ostringstream();
+        test_stream << lessThan(x.squaredNorm(), x(0) * x(1));
+        REQUIRE(test_stream.str() == "(x[0])^2 + (x[1])^2 <= (x[0]) * (x[1])");
+
         test_stream = std::ostringstream();
         test_stream << box(-1., x.sum(), 1.);
         REQUIRE(test_stream.str() == "-1 <= x[0] + x[1] <= 1");
@@ -65,8 +73,99 @@ TEST_CASE("Constraint")
         VectorX x = op.addVariable("x", 3);
 
         REQUIRE_THROWS(lessThan(x(0), x.norm()));
-        REQUIRE_THROWS(lessThan(x.squaredNorm(), x(0)));
+        REQUIRE_THROWS(lessThan(x(0), norm2(x)));
+        REQUIRE_THROWS(norm2(VectorX(x.cwiseAbs2())));
+        REQUIRE_THROWS(lessThan(x.squaredNorm(), x(0) * x(1) + x(2)));
+        REQUIRE_THROWS(lessThan(x(0) * x(1), x(2)));
+        REQUIRE_THROWS(lessThan(x.squaredNorm(), x.squaredNorm()));
         REQUIRE_THROWS(box(x(0), x.squaredNorm(), x(1)));
         REQUIRE_THROWS(equalTo(x, x.squaredNorm()));
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Constraint handle")
+{
+    { // QP
+        OptimizationProblem qp;
+        VectorX x = qp.addVariable("x", 2);
+
+        ConstraintHandle upper = qp.addConstraint(lessThan(x, 1.));
+        qp.addCostTerm(x.squaredNorm() - 4. * x.sum());
+
+        osqp::OSQPSolver solver(qp);
+
+        solver.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(1., 1.)).cwiseAbs().maxCoeff() < 1e-3);
+
+        upper.disable();
+        REQUIRE_FALSE(upper.isEnabled());
+        solver.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(2., 2.)).cwiseAbs().maxCoeff() < 1e-3);
+        REQUIRE(solver.isFeasible(1e-3));
+
+        upper.enable();
+        solver.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(1., 1.)).cwiseAbs().maxCoeff() < 1e-3);
+    }
+    { // SOCP
+        OptimizationProblem socp;
+        VectorX x = socp.addVariable("x", 2);
+
+        socp.addConstraint(box(-3., x, 3.));
+        ConstraintHandle cone = socp.addConstraint(lessThan(x.norm(), 1.));
+        ConstraintHandle upper = socp.addConstraint(lessThan(x, 0.5));
+        ConstraintHandle equality = socp.addConstraint(equalTo(x(0), x(1)));
+        socp.addCostTerm(-x.sum());
+
+        ecos::ECOSSolver solver(socp);
+
+        solver.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(0.5, 0.5)).cwiseAbs().maxCoeff() < 1e-5);
+
+        upper.disable();
+        solver.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d::Constant(std::sqrt(0.5))).cwiseAbs().maxCoeff() < 1e-5);
+
+        cone.disable();
+        solver.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(3., 3.)).cwiseAbs().maxCoeff() < 1e-5);
+        REQUIRE(solver.isFeasible(1e-5));
+
+        cone.enable();
+        upper.enable();
+        solver.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(0.5, 0.5)).cwiseAbs().maxCoeff() < 1e-5);
+
+        equality.disable();
+        REQUIRE(solver.solve(false));
+        REQUIRE(solver.getExitCode() == ECOS_OPTIMAL);
+        REQUIRE((eval(x) - Eigen::Vector2d(0.5, 0.5)).cwiseAbs().maxCoeff() < 1e-5);
+    }
+    { // SOCP with a disabled equality constraint, relaxed to 0 == 0
+        OptimizationProblem socp;
+        VectorX x = socp.addVariable("x", 2);
+
+        socp.addConstraint(box(-1., x, 1.));
+        ConstraintHandle equality = socp.addConstraint(equalTo(x(0), 0.));
+        socp.addCostTerm(-x.sum());
+
+        ecos::ECOSSolver solver(socp);
+
+        solver.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(0., 1.)).cwiseAbs().maxCoeff() < 1e-5);
+
+        // A is rank deficient now, which ECOS handles with its regularization
+        equality.disable();
+        REQUIRE(solver.solve(false));
+        REQUIRE(solver.getExitCode() == ECOS_OPTIMAL);
+        REQUIRE((eval(x) - Eigen::Vector2d(1., 1.)).cwiseAbs().maxCoeff() < 1e-5);
+        REQUIRE(solver.isFeasible(1e-5));
+
+        equality.enable();
+        solver.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(0., 1.)).cwiseAbs().maxCoeff() < 1e-5);
+    }
+    {
+        ConstraintHandle handle;
+        REQUIRE_THROWS(handle.disable());
+    }
+}
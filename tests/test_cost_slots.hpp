@@ -0,0 +1,58 @@
+using namespace cvx;
+
+TEST_CASE("Cost slots")
+{
+    { // QP
+        OptimizationProblem qp;
+        VectorX x = qp.addVariable("x", 2);
+
+        qp.addConstraint(equalTo(x.sum(), 1.));
+        qp.addConstraint(box(-5., x, 5.));
+
+        // The first slot is active
+        qp.addCostSlotTerm("tracking", x.squaredNorm() - 2. * x(0) - 4. * x(1));
+        qp.addCostSlotTerm("energy", x.squaredNorm());
+
+        osqp::OSQPSolver solver(qp);
+
+        solver.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(0., 1.)).cwiseAbs().maxCoeff() < 1e-3);
+
+        qp.activateCostSlot("energy");
+        solver.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(0.5, 0.5)).cwiseAbs().maxCoeff() < 1e-3);
+        REQUIRE(qp.getOptimalValue() == Approx(0.5).margin(1e-3));
+
+        qp.activateCostSlot("tracking");
+        solver.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(0., 1.)).cwiseAbs().maxCoeff() < 1e-3);
+
+        REQUIRE_THROWS(qp.activateCostSlot("time"));
+        REQUIRE_THROWS(qp.setCostSlotWeight("time", 1.));
+    }
+    { // SOCP
+        OptimizationProblem socp;
+        VectorX x = socp.addVariable("x", 2);
+
+        socp.addConstraint(box(-1., x, 1.));
+        socp.addCostTerm(x(1));
+        socp.addCostSlotTerm("max", -x(0));
+        socp.addCostSlotTerm("min", x(0));
+
+        ecos::ECOSSolver solver(socp);
+
+        solver.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(1., -1.)).cwiseAbs().maxCoeff() < 1e-5);
+
+        socp.activateCostSlot("min");
+        solver.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(-1., -1.)).cwiseAbs().maxCoeff() < 1e-5);
+
+        // Weights can be set directly
+        socp.setCostSlotWeight("min", 0.);
+        socp.setCostSlotWeight("max", 2.);
+        solver.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(1., -1.)).cwiseAbs().maxCoeff() < 1e-5);
+        REQUIRE(socp.getOptimalValue() == Approx(-3.).margin(1e-5));
+    }
+}
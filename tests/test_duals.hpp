@@ -0,0 +1,89 @@
+using namespace cvx;
+
+TEST_CASE("Duals and slacks")
+{
+    SECTION("QP")
+    {
+        for (bool presolve : {false, true})
+        {
+            OptimizationProblem qp;
+            Scalar x = qp.addVariable("x");
+            Scalar y = qp.addVariable("y");
+
+            ConstraintHandle upper = qp.addConstraint(lessThan(x, 1.));
+            ConstraintHandle lower = qp.addConstraint(greaterThan(y, 0.));
+            ConstraintHandle limits = qp.addConstraint({box(-5., x, 5.), box(-5., y, 4.)});
+            qp.addCostTerm(square(x - 2.) + square(y + 1.));
+
+            osqp::OSQPSolver solver(qp, presolve);
+
+            Eigen::VectorXd duals;
+            REQUIRE_THROWS(solver.getDualValue(upper, duals));
+
+            solver.solve(false);
+            REQUIRE(eval(x) == Approx(1.).margin(1e-3));
+            REQUIRE(eval(y) == Approx(0.).margin(1e-3));
+
+            // Stationarity: 2(x - 2) + a'y = 0
+            solver.getDualValue(upper, duals);
+            REQUIRE(duals.size() == 1);
+            REQUIRE(std::abs(duals(0)) == Approx(2.).margin(1e-2));
+            solver.getDualValue(lower, duals);
+            REQUIRE(std::abs(duals(0)) == Approx(2.).margin(1e-2));
+            solver.getDualValue(limits, duals);
+            REQUIRE(duals.size() == 2);
+            REQUIRE(duals.cwiseAbs().maxCoeff() < 1e-2);
+
+            Eigen::VectorXd slacks;
+            qp.getSlackValue(upper, slacks);
+            REQUIRE(slacks.size() == 1);
+            REQUIRE(slacks(0) == Approx(0.).margin(1e-3));
+            qp.getSlackValue(limits, slacks);
+            REQUIRE(slacks.size() == 2);
+            REQUIRE(slacks(0) == Approx(4.).margin(1e-3));
+            REQUIRE(slacks(1) == Approx(4.).margin(1e-3));
+
+            OptimizationProblem other;
+            ConstraintHandle other_handle = other.addConstraint(greaterThan(other.addVariable("z"), 0.));
+            REQUIRE_THROWS(solver.getDualValue(other_handle, duals));
+            REQUIRE_THROWS(qp.getSlackValue(other_handle, slacks));
+        }
+    }
+
+    SECTION("SOCP")
+    {
+        for (bool presolve : {false, true})
+        {
+            OptimizationProblem socp;
+            Scalar x = socp.addVariable("x");
+            Scalar y = socp.addVariable("y");
+
+            ConstraintHandle upper = socp.addConstraint(lessThan(x, 1.));
+            ConstraintHandle lower = socp.addConstraint(greaterThan(y, 0.));
+            VectorX v(2);
+            v << x, y;
+            ConstraintHandle cone = socp.addConstraint(lessThan(v.norm(), 3.));
+            socp.addCostTerm(-2. * x + y);
+
+            ecos::ECOSSolver solver(socp, presolve);
+            solver.solve(false);
+            REQUIRE(eval(x) == Approx(1.).margin(1e-3));
+            REQUIRE(eval(y) == Approx(0.).margin(1e-3));
+
+            Eigen::VectorXd duals;
+            solver.getDualValue(upper, duals);
+            REQUIRE(duals.size() == 1);
+            REQUIRE(std::abs(duals(0)) == Approx(2.).margin(1e-2));
+            solver.getDualValue(lower, duals);
+            REQUIRE(std::abs(duals(0)) == Approx(1.).margin(1e-2));
+            solver.getDualValue(cone, duals);
+            REQUIRE(duals.size() == 3);
+            REQUIRE(duals.cwiseAbs().maxCoeff() < 1e-2);
+
+            Eigen::VectorXd slacks;
+            socp.getSlackValue(cone, slacks);
+            REQUIRE(slacks.size() == 1);
+            REQUIRE(slacks(0) == Approx(2.).margin(1e-3));
+        }
+    }
+}
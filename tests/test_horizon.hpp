@@ -0,0 +1,134 @@
+using namespace cvx;
+
+TEST_CASE("Horizon parameter")
+{
+    Eigen::MatrixXd values(2, 4);
+    values << 1., 2., 3., 4.,
+        5., 6., 7., 8.;
+
+    HorizonParameter p(values);
+    REQUIRE(p.rows() == 2);
+    REQUIRE(p.stages() == 4);
+    REQUIRE(p.getValues() == values);
+
+    const MatrixX params = dynpar(p);
+    REQUIRE(eval(params) == values);
+
+    p.shift();
+    REQUIRE(p.getStage(0) == values.col(1));
+    REQUIRE(p.getStage(3) == values.col(0));
+
+    p.setStage(3, Eigen::Vector2d(9., 10.));
+    Eigen::MatrixXd shifted(2, 4);
+    shifted << 2., 3., 4., 9.,
+        6., 7., 8., 10.;
+    REQUIRE(p.getValues() == shifted);
+
+    // The parameters follow the stages
+    REQUIRE(eval(params) == shifted);
+
+    REQUIRE_THROWS(p.setStage(4, Eigen::Vector2d(0., 0.)));
+    REQUIRE_THROWS(p.setStage(0, Eigen::Vector3d(0., 0., 0.)));
+}
+
+TEST_CASE("Receding horizon warm start")
+{
+    Eigen::MatrixXd reference(1, 5);
+    reference << 0., 0.5, 1., 2., 3.;
+
+    auto build = [](OptimizationProblem &qp, ConstraintHandle &upper, const HorizonParameter &r) {
+        MatrixX x = qp.addVariable("x", 1, 5);
+        upper = qp.addConstraint(lessThan(x, 1.));
+        qp.addCostTerm((x - dynpar(r)).squaredNorm());
+        return x;
+    };
+
+    HorizonParameter r(reference);
+    OptimizationProblem qp;
+    ConstraintHandle upper;
+    MatrixX x = build(qp, upper, r);
+
+    osqp::OSQPSolver solver(qp);
+    solver.setCheckTermination(1);
+    solver.solve(false);
+    REQUIRE((eval(x) - Eigen::RowVectorXd::LinSpaced(5, 0., 2.).cwiseMin(1.)).cwiseAbs().maxCoeff() < 1e-2);
+
+    // Move the horizon by one stage and append the new reference
+    r.shift();
+    r.setStage(4, Eigen::VectorXd::Constant(1, 4.));
+    solver.shiftWarmStart("x");
+    solver.shiftWarmStart(upper, 5);
+    solver.solve(false);
+
+    Eigen::RowVectorXd expected(5);
+    expected << 0.5, 1., 1., 1., 1.;
+    REQUIRE((eval(x) - expected).cwiseAbs().maxCoeff() < 1e-2);
+
+    // A cold solve of the shifted horizon needs more iterations
+    HorizonParameter r_cold(r.getValues());
+    OptimizationProblem qp_cold;
+    ConstraintHandle upper_cold;
+    MatrixX x_cold = build(qp_cold, upper_cold, r_cold);
+
+    osqp::OSQPSolver cold(qp_cold);
+    cold.setCheckTermination(1);
+    cold.solve(false);
+    REQUIRE((eval(x_cold) - expected).cwiseAbs().maxCoeff() < 1e-2);
+    REQUIRE(solver.getInfo().iter < cold.getInfo().iter);
+
+    REQUIRE_THROWS(solver.shiftWarmStart(upper, 3));
+    REQUIRE_THROWS(solver.shiftWarmStart(upper_cold, 5));
+    REQUIRE_THROWS(solver.shiftWarmStart("y"));
+}
+
+// Exposes the warm start duals of the canonicalized problem without a solver
+class DualGuessWrapper final : public internal::QPWrapperBase
+{
+public:
+    using internal::QPWrapperBase::QPWrapperBase;
+    using internal::QPWrapperBase::getSolverDualGuess;
+    using internal::QPWrapperBase::setDualGuess;
+    using internal::QPWrapperBase::shiftDualGuess;
+
+    bool solve(bool) override { return false; }
+    bool solve(const CancellationToken &, bool) override { return false; }
+    std::string getResultString() const override { return ""; }
+
+private:
+    void evaluatePreparedUpdate() override {}
+    void swapUpdateBuffers() override {}
+    void rebuildWorkspace() override {}
+};
+
+TEST_CASE("Receding horizon dual shift")
+{
+    // Box constraints with variable bounds create two rows per constraint
+    OptimizationProblem qp;
+    MatrixX x = qp.addVariable("x", 2, 3);
+    MatrixX lower = qp.addVariable("lower", 2, 3);
+    ConstraintHandle box_handle = qp.addConstraint(box(lower, x, par(Eigen::MatrixXd::Ones(2, 3))));
+    qp.addCostTerm(x.squaredNorm());
+
+    DualGuessWrapper wrapper(qp, false);
+    REQUIRE(wrapper.getSolverDualGuess().size() == 12);
+
+    wrapper.setDualGuess(box_handle, Eigen::VectorXd::LinSpaced(12, 0., 11.));
+    wrapper.shiftDualGuess(box_handle, 3);
+
+    // Each constraint takes both rows of the next stage
+    Eigen::VectorXd expected(12);
+    expected << 2., 3., 4., 5., 4., 5.,
+        8., 9., 10., 11., 10., 11.;
+    REQUIRE(wrapper.getSolverDualGuess() == expected);
+
+    REQUIRE_THROWS(wrapper.shiftDualGuess(box_handle, 4));
+
+    // Constraints of different types can not be shifted as a matrix
+    OptimizationProblem mixed;
+    MatrixX y = mixed.addVariable("y", 1, 2);
+    ConstraintHandle mixed_handle = mixed.addConstraint({lessThan(y(0, 0), 1.), equalTo(y(0, 1), 0.5)});
+    mixed.addCostTerm(y.squaredNorm());
+
+    DualGuessWrapper mixed_wrapper(mixed, false);
+    REQUIRE_THROWS(mixed_wrapper.shiftDualGuess(mixed_handle, 1));
+}
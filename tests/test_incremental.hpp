@@ -0,0 +1,79 @@
+using namespace cvx;
+
+TEST_CASE("Incremental QP")
+{
+    OptimizationProblem qp;
+    VectorX x = qp.addVariable("x", 2);
+
+    ConstraintHandle positive = qp.addConstraint(greaterThan(x, 0.));
+    qp.addCostTerm(x.squaredNorm() - 6. * x.sum());
+
+    osqp::OSQPSolver solver(qp);
+    solver.solve(false);
+    REQUIRE((eval(x) - Eigen::Vector2d(3., 3.)).cwiseAbs().maxCoeff() < 1e-3);
+
+    // Add a cut
+    qp.addConstraint(lessThan(x.sum(), 2.));
+    solver.addNewConstraints();
+    REQUIRE(solver.getNumInequalityConstraints() == 3);
+    solver.solve(false);
+    REQUIRE((eval(x) - Eigen::Vector2d(1., 1.)).cwiseAbs().maxCoeff() < 1e-3);
+
+    // Add a constraint with a new variable
+    Scalar y = qp.addVariable("y");
+    qp.addConstraint(equalTo(y, x(0)));
+    qp.addConstraint(box(-1., y, 0.5));
+    solver.addNewConstraints();
+    REQUIRE(solver.getNumVariables() == 3);
+    solver.solve(false);
+    REQUIRE((eval(x) - Eigen::Vector2d(0.5, 1.5)).cwiseAbs().maxCoeff() < 1e-3);
+    REQUIRE(eval(y) == Approx(0.5).margin(1e-3));
+    REQUIRE(solver.isFeasible(1e-3));
+
+    // Handles of earlier constraints keep working
+    qp.addConstraint(lessThan(x(1), -1.));
+    solver.addNewConstraints();
+    positive.disable();
+    solver.solve(false);
+    REQUIRE(eval(x(1)) == Approx(-1.).margin(1e-3));
+
+    // Nothing new
+    solver.addNewConstraints();
+    REQUIRE(solver.getNumInequalityConstraints() == 6);
+
+    qp.addCostTerm(y);
+    REQUIRE_THROWS(solver.addNewConstraints());
+}
+
+TEST_CASE("Incremental SOCP")
+{
+    OptimizationProblem socp;
+    VectorX x = socp.addVariable("x", 2);
+
+    socp.addConstraint(box(-3., x, 3.));
+    socp.addConstraint(lessThan(x.norm(), 2.));
+    socp.addCostTerm(-x.sum());
+
+    ecos::ECOSSolver solver(socp);
+    solver.solve(false);
+    REQUIRE((eval(x) - Eigen::Vector2d::Constant(std::sqrt(2.))).cwiseAbs().maxCoeff() < 1e-5);
+
+    // The new positive constraint is placed before the existing cone
+    socp.addConstraint(lessThan(x(0), 0.5));
+    solver.addNewConstraints();
+    REQUIRE(solver.getNumPositiveConstraints() == 5);
+    REQUIRE(solver.getNumCones() == 1);
+    solver.solve(false);
+    REQUIRE((eval(x) - Eigen::Vector2d(0.5, std::sqrt(3.75))).cwiseAbs().maxCoeff() < 1e-5);
+
+    // Another cone and an equality with a new variable
+    Scalar t = socp.addVariable("t");
+    socp.addConstraint(lessThan(x.norm(), t));
+    socp.addConstraint(equalTo(t, 1.));
+    solver.addNewConstraints();
+    REQUIRE(solver.getNumCones() == 2);
+    REQUIRE(solver.getNumEqualityConstraints() == 1);
+    solver.solve(false);
+    REQUIRE((eval(x) - Eigen::Vector2d(0.5, std::sqrt(0.75))).cwiseAbs().maxCoeff() < 1e-5);
+    REQUIRE(solver.isFeasible(1e-6));
+}
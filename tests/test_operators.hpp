@@ -0,0 +1,99 @@
+using namespace cvx;
+
+TEST_CASE("Linear operators")
+{
+    Eigen::VectorXd v(4);
+    v << 1, 2, 4, 8;
+    Eigen::VectorXd d(4);
+    d << 1, -1, 2, 0.5;
+    Eigen::MatrixXd A(2, 2);
+    A << 2, -1, 1, 0.2;
+
+    const VectorX x = par(v);
+
+    REQUIRE(identity(4).nonZeros() == 4);
+    REQUIRE(eval(identity(4) * x) == v);
+
+    // Dynamic diagonal coefficients
+    const LinearOperator D = diagonal(dynpar(d));
+    REQUIRE(D.nonZeros() == 4);
+    REQUIRE(eval(D * x) == d.cwiseProduct(v));
+    d(3) = 4.;
+    REQUIRE(eval(D * x) == d.cwiseProduct(v));
+
+    // Shifts
+    Eigen::VectorXd forward(4), backward(4);
+    forward << 2, 4, 8, 0;
+    backward << 0, 1, 2, 4;
+    REQUIRE(shift(4, 1).nonZeros() == 3);
+    REQUIRE(eval(shift(4, 1) * x) == forward);
+    REQUIRE(eval(shift(4, -1) * x) == backward);
+    REQUIRE(eval((shift(4, 1) - identity(4)) * x) == forward - v);
+
+    // Block diagonal
+    const LinearOperator K = kron(identity(2), par(A));
+    REQUIRE(K.nonZeros() == 8);
+    Eigen::MatrixXd K_dense = Eigen::MatrixXd::Zero(4, 4);
+    K_dense.topLeftCorner(2, 2) = A;
+    K_dense.bottomRightCorner(2, 2) = A;
+    REQUIRE(eval(K * x) == K_dense * v);
+    REQUIRE(eval(kron(identity(2), identity(2)) * x) == v);
+
+    // Constant zeros are not stored
+    Eigen::MatrixXd A_sparse = A;
+    A_sparse(0, 1) = 0.;
+    REQUIRE(kron(identity(3), par(A_sparse)).nonZeros() == 9);
+    REQUIRE(diagonal(par(Eigen::Vector3d(1., 0., 2.))).nonZeros() == 2);
+    REQUIRE(Scalar(0.).isZero());
+    REQUIRE_FALSE(Scalar(1.).isZero());
+}
+
+TEST_CASE("Linear operator MPC")
+{
+    const size_t T = 10;
+
+    Eigen::MatrixXd A(2, 2);
+    A << 2, -1, 1, 0.2;
+    Eigen::MatrixXd B(2, 1);
+    B << 1, 0;
+    Eigen::VectorXd x0(2);
+    x0 << 3, 1;
+
+    // Reference with one constraint per time step
+    Eigen::MatrixXd x_ref, u_ref;
+    {
+        OptimizationProblem qp;
+        MatrixX x = qp.addVariable("x", 2, T + 1);
+        MatrixX u = qp.addVariable("u", 1, T);
+        for (size_t t = 0; t < T; t++)
+        {
+            qp.addConstraint(equalTo(x.col(t + 1), par(A) * x.col(t) + par(B) * u.col(t)));
+        }
+        qp.addConstraint(equalTo(x.col(0), par(x0)));
+        qp.addConstraint(box(-2., u, 2.));
+        qp.addCostTerm(x.squaredNorm() + u.squaredNorm());
+
+        osqp::OSQPSolver solver(qp);
+        solver.solve(false);
+        x_ref = eval(x);
+        u_ref = eval(u);
+    }
+
+    // Stacked dynamics with block diagonal operators
+    OptimizationProblem qp;
+    VectorX x = qp.addVariable("x", 2 * (T + 1));
+    VectorX u = qp.addVariable("u", T);
+    qp.addConstraint(equalTo(x.tail(2 * T),
+                             kron(identity(T), par(A)) * x.head(2 * T) + kron(identity(T), par(B)) * u));
+    qp.addConstraint(equalTo(x.head(2), par(x0)));
+    qp.addConstraint(box(-2., u, 2.));
+    qp.addCostTerm(x.squaredNorm() + u.squaredNorm());
+
+    osqp::OSQPSolver solver(qp);
+    solver.solve(false);
+
+    const Eigen::VectorXd x_eval = eval(x);
+    const Eigen::VectorXd u_eval = eval(u);
+    REQUIRE((Eigen::Map<const Eigen::MatrixXd>(x_eval.data(), 2, T + 1) - x_ref).cwiseAbs().maxCoeff() < 1e-3);
+    REQUIRE((u_eval.transpose() - u_ref).cwiseAbs().maxCoeff() < 1e-3);
+}
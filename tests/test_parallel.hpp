@@ -0,0 +1,110 @@
+#include "wrappers/parallel.hpp"
+
+using namespace cvx;
+
+TEST_CASE("Parallel for")
+{
+    std::vector<int> visits(1000, 0);
+    internal::parallelFor(10, visits.size(), [&](size_t i) { visits[i]++; }, 1);
+    REQUIRE(std::all_of(visits.begin(), visits.begin() + 10, [](int v) { return v == 0; }));
+    REQUIRE(std::all_of(visits.begin() + 10, visits.end(), [](int v) { return v == 1; }));
+
+    internal::parallelFor(5, 5, [&](size_t) { FAIL("Empty range"); });
+
+    REQUIRE_THROWS_AS(internal::parallelFor(0, 100, [](size_t i) {
+        if (i == 42)
+        {
+            throw std::runtime_error("Failed");
+        }
+    },
+                                            1),
+                      std::runtime_error);
+}
+
+TEST_CASE("Parallel canonicalization")
+{
+    // Run the pre-pass on several threads even though the problems are small
+    struct SettingsGuard
+    {
+        const internal::ParallelSettings saved = internal::parallel_settings;
+        ~SettingsGuard() { internal::parallel_settings = saved; }
+    } guard;
+
+    const size_t n = 50;
+    const Eigen::VectorXd b = Eigen::VectorXd::Random(n);
+    Eigen::VectorXd upper = b;
+
+    auto formulate = [&](OptimizationProblem &op, bool cones) {
+        VectorX x = op.addVariable("x", n);
+        Scalar t = op.addVariable("t");
+        Scalar s = op.addVariable("s");
+        op.addConstraint(box(par(Eigen::VectorXd(b.array() - 1.)), x + x, par(Eigen::VectorXd(b.array() + 1.))));
+        op.addConstraint(box(-t, x, t));
+        op.addConstraint(lessThan(x, dynpar(upper)));
+        op.addConstraint(equalTo(x.head(n / 2), x.tail(n / 2)));
+        op.addConstraint(lessThan(norm1(x.head(3)), s));
+        if (cones)
+        {
+            for (size_t i = 0; i + 1 < n; i++)
+            {
+                op.addConstraint(lessThan(x.segment(i, 2).norm(), t + 3.));
+                op.addConstraint(lessThan(x.segment(i, 2).squaredNorm(), t * s));
+            }
+            op.addCostTerm(t + s);
+        }
+        else
+        {
+            op.addCostTerm(x.squaredNorm() + t + s);
+        }
+    };
+
+    auto canonicalize = [&](size_t max_threads, bool cones) {
+        internal::parallel_settings.max_threads = max_threads;
+        internal::parallel_settings.min_chunk = 1;
+
+        OptimizationProblem op;
+        formulate(op, cones);
+        std::stringstream stream;
+        if (cones)
+        {
+            ecos::ECOSSolver solver(op);
+            stream << solver;
+        }
+        else
+        {
+            osqp::OSQPSolver solver(op);
+            stream << solver;
+        }
+        return stream.str();
+    };
+
+    // The same problem data as a serial canonicalization
+    for (bool cones : {false, true})
+    {
+        REQUIRE(canonicalize(4, cones) == canonicalize(1, cones));
+    }
+
+    // Many small constraints in one batch produce the same problem as adding them one by one
+    internal::parallel_settings.max_threads = 4;
+    OptimizationProblem qp1;
+    OptimizationProblem qp2;
+    VectorX x1 = qp1.addVariable("x", n);
+    VectorX x2 = qp2.addVariable("x", n);
+
+    qp1.addConstraint(box(par(Eigen::VectorXd(b.array() - 1.)), x1 + x1, par(Eigen::VectorXd(b.array() + 1.))));
+    qp1.addCostTerm(x1.squaredNorm());
+    osqp::OSQPSolver solver1(qp1);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        qp2.addConstraint(box(par(b(i) - 1.), x2(i) + x2(i), par(b(i) + 1.)));
+    }
+    qp2.addCostTerm(x2.squaredNorm());
+    osqp::OSQPSolver solver2(qp2);
+
+    std::stringstream s1;
+    std::stringstream s2;
+    s1 << solver1;
+    s2 << solver2;
+    REQUIRE(s1.str() == s2.str());
+}
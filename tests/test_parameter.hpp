@@ -120,3 +120,134 @@ TEST_CASE("Parameter")
         REQUIRE_FALSE(sqrt(p2 / p1) == sqrt(p1 / p2));
     }
 }
+
+TEST_CASE("Parameter sum and matrix")
+{
+    using namespace cvx::internal;
+
+    double a = 2.;
+    double b = 3.;
+    const Parameter pa(&a);
+    const Parameter pb(&b);
+
+    // Constants are combined
+    REQUIRE(sum({Parameter(1.), Parameter(2.)}).isConstant());
+    REQUIRE(sum({Parameter(1.), Parameter(2.)}).getValue() == 3.);
+    REQUIRE(sum({pa, Parameter(0.)}) == pa);
+
+    const Parameter s = sum({pa, Parameter(1.), pb, Parameter(4.)});
+    REQUIRE_FALSE(s.isConstant());
+    REQUIRE(s.getValue() == 10.);
+    a = 4.;
+    REQUIRE(s.getValue() == 12.);
+    REQUIRE(s == sum({pa, pb, Parameter(5.)}));
+    REQUIRE_FALSE(s == sum({pa, pa, Parameter(5.)}));
+
+    // Duplicates are merged, the pattern is sorted by columns and rows
+    CoefficientList coeffs;
+    coeffs.add(2, 1, pa);
+    coeffs.add(0, 1, Parameter(1.));
+    coeffs.add(2, 1, pb);
+    coeffs.add(1, 0, Parameter(5.));
+    coeffs.add(2, 1, Parameter(1.));
+
+    ParameterMatrix m(3, 3);
+    m.setFromCoefficients(coeffs);
+    REQUIRE(m.nonZeros() == 3);
+
+    Eigen::MatrixXd expected = Eigen::MatrixXd::Zero(3, 3);
+    expected(1, 0) = 5.;
+    expected(0, 1) = 1.;
+    expected(2, 1) = a + b + 1.;
+    REQUIRE(Eigen::MatrixXd(eval(m)) == expected);
+
+    b = -1.;
+    expected(2, 1) = a + b + 1.;
+    REQUIRE(Eigen::MatrixXd(eval(m)) == expected);
+
+    // Appending rows and columns keeps the nonzeros
+    m.conservativeResize(4, 5);
+    CoefficientList more;
+    m.appendTo(more, 1);
+    more.add(0, 4, Parameter(2.));
+    ParameterMatrix shifted(4, 5);
+    shifted.setFromCoefficients(more);
+    REQUIRE(shifted.nonZeros() == 4);
+    REQUIRE(Eigen::MatrixXd(eval(shifted)).block(1, 0, 3, 3) == expected);
+    REQUIRE(Eigen::MatrixXd(eval(shifted))(0, 4) == 2.);
+}
+
+TEST_CASE("Affine parameter map")
+{
+    using namespace cvx::internal;
+
+    double a = 2.;
+    double b = 3.;
+    const Parameter pa(&a);
+    const Parameter pb(&b);
+
+    std::vector<Parameter> params = {
+        Parameter(4.),
+        pa,
+        Parameter(2.) * pa + pb - Parameter(1.),
+        (pa + pb) / Parameter(2.),
+        sum({pa, Parameter(3.) * pa, pb}),
+        pa * pb,
+        sqrt(pb),
+        pa / pb,
+        max(pa, pb) + pa,
+    };
+
+    const AffineParameterMap map(params);
+    REQUIRE(map.size() == params.size());
+    REQUIRE(map.getNumParameters() == 2);
+    REQUIRE(map.getNumNonaffine() == 4);
+    REQUIRE(map.getDynamicIndices() == std::vector<size_t>{1, 2, 3, 4, 5, 6, 7, 8});
+
+    auto expected = [&]() {
+        Eigen::VectorXd values(params.size());
+        for (size_t i = 0; i < params.size(); i++)
+        {
+            values(i) = params[i].getValue();
+        }
+        return values;
+    };
+
+    REQUIRE(map.evaluate().isApprox(expected()));
+
+    a = -1.5;
+    b = 7.;
+    REQUIRE(map.evaluate().isApprox(expected()));
+
+    // Only the dynamic entries are updated
+    Eigen::VectorXd updated = map.evaluate();
+    updated(0) = 100.;
+    a = 0.5;
+    map.updateDynamic(updated);
+    REQUIRE(updated(0) == 100.);
+    REQUIRE(updated.tail(8).isApprox(expected().tail(8)));
+
+    // In place and scaled
+    const AffineParameterMap negated_map(params, -1.);
+    Eigen::VectorXd values(params.size());
+    negated_map.evaluate(values);
+    REQUIRE(values.isApprox(-expected()));
+
+    // Read a from other memory, including the entries that use the expression tree
+    double other_a = 4.;
+    const AffineParameterMap rebound_map = map.rebind({&a}, {&other_a});
+    const Eigen::VectorXd before = expected();
+    const Eigen::VectorXd rebound = rebound_map.evaluate();
+    REQUIRE(map.evaluate().isApprox(before));
+    const double original_a = a;
+    a = other_a;
+    REQUIRE(rebound.isApprox(expected()));
+    a = original_a;
+    REQUIRE_THROWS(map.rebind({&a, &b}, {&other_a}));
+
+    // Only constants
+    const AffineParameterMap constant_map(std::vector<Parameter>{Parameter(1.), Parameter(-2.)});
+    REQUIRE(constant_map.getNumParameters() == 0);
+    REQUIRE(constant_map.getDynamicIndices().empty());
+    REQUIRE(constant_map.evaluate() == Eigen::Vector2d(1., -2.));
+}
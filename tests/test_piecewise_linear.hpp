@@ -0,0 +1,129 @@
+using namespace cvx;
+
+TEST_CASE("Piecewise linear constraints")
+{
+    auto formulate = [](OptimizationProblem &op, ConstraintHandle &max_handle) {
+        VectorX x = op.addVariable("x", 2);
+        op.addConstraint(lessThan(normInf(x), 2.));
+        op.addConstraint(lessThan(norm1(x), 3.));
+        op.addConstraint(lessThan(pos(x(1) - 0.5), 0.25));
+        op.addConstraint(lessThan(abs(x(1)), 1.));
+        max_handle = op.addConstraint(lessThan(max(x), 1.5));
+        op.addCostTerm(-2. * x(0) - x(1));
+        return x;
+    };
+
+    auto check = [](const VectorX &x, ConstraintHandle &max_handle, auto &solver) {
+        solver.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(1.5, 0.75)).cwiseAbs().maxCoeff() < 1e-3);
+        REQUIRE(eval(norm1(x)) == Approx(2.25).margin(1e-3));
+        REQUIRE(eval(normInf(x)) == Approx(1.5).margin(1e-3));
+        REQUIRE(eval(max(x)) == Approx(1.5).margin(1e-3));
+        REQUIRE(eval(pos(x(1) - 1.)) == 0.);
+        REQUIRE(eval(abs(-x(0))) == Approx(1.5).margin(1e-3));
+
+        // The slack rows are relaxed with the constraint
+        max_handle.disable();
+        solver.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(2., 0.75)).cwiseAbs().maxCoeff() < 1e-3);
+        max_handle.enable();
+    };
+
+    {
+        OptimizationProblem qp;
+        ConstraintHandle max_handle;
+        VectorX x = formulate(qp, max_handle);
+        osqp::OSQPSolver solver(qp);
+        check(x, max_handle, solver);
+    }
+    {
+        OptimizationProblem socp;
+        ConstraintHandle max_handle;
+        VectorX x = formulate(socp, max_handle);
+        ecos::ECOSSolver solver(socp);
+
+        // 2 * 2 + 2 * 2 + 2 + 2 + 2 slack rows and 5 constraint rows
+        REQUIRE(solver.getNumPositiveConstraints() == 19);
+        check(x, max_handle, solver);
+    }
+
+    {
+        OptimizationProblem op;
+        VectorX x = op.addVariable("x", 2);
+
+        auto test_stream = std::ostringstream();
+        test_stream << lessThan(norm1(x) + 2. * max(x), 1.);
+        REQUIRE(test_stream.str() == "norm1(x[0], x[1]) + 2 * max(x[0], x[1]) <= 1");
+
+        REQUIRE_THROWS(lessThan(1., norm1(x)));
+        REQUIRE_THROWS(lessThan(-norm1(x), 1.));
+        REQUIRE_THROWS(equalTo(norm1(x), 1.));
+        REQUIRE_THROWS(norm1(x) * x(0));
+        REQUIRE_THROWS(sqrt(norm1(x)));
+        REQUIRE_THROWS(max(VectorX()));
+    }
+}
+
+TEST_CASE("Piecewise linear cost")
+{
+    // Sparse regression: minimize ||A x - b||^2 + lambda * ||x||_1
+    Eigen::MatrixXd A(4, 3);
+    A << 1, 2, 0,
+        0, 1, 1,
+        2, 0, 1,
+        1, 1, 1;
+    Eigen::Vector4d b(1, 2, 0.5, 3);
+    const double lambda = 2.;
+
+    // Reference with explicit slack variables
+    Eigen::VectorXd x_ref;
+    {
+        OptimizationProblem qp;
+        VectorX x = qp.addVariable("x", 3);
+        VectorX s = qp.addVariable("s", 3);
+        qp.addConstraint(greaterThan(s, x));
+        qp.addConstraint(greaterThan(s, -x));
+        qp.addCostTerm((par(A) * x - par(b)).squaredNorm() + lambda * s.sum());
+
+        osqp::OSQPSolver solver(qp);
+        solver.solve(false);
+        x_ref = eval(x);
+    }
+
+    auto formulate = [&](OptimizationProblem &op) {
+        VectorX x = op.addVariable("x", 3);
+        op.addCostTerm((par(A) * x - par(b)).squaredNorm() + lambda * norm1(x));
+        return x;
+    };
+
+    {
+        OptimizationProblem qp;
+        VectorX x = formulate(qp);
+        osqp::OSQPSolver solver(qp);
+        solver.solve(false);
+        REQUIRE((eval(x) - x_ref).cwiseAbs().maxCoeff() < 1e-3);
+    }
+    {
+        OptimizationProblem socp;
+        VectorX x = formulate(socp);
+        ecos::ECOSSolver solver(socp);
+        solver.solve(false);
+        REQUIRE((eval(x) - x_ref).cwiseAbs().maxCoeff() < 1e-3);
+    }
+    {
+        // Minimax in a cost slot
+        OptimizationProblem socp;
+        VectorX x = socp.addVariable("x", 2);
+        socp.addConstraint(equalTo(x.sum(), 1.));
+        socp.addCostSlotTerm("minimax", normInf(x - par(Eigen::Vector2d(2., 0.))));
+        ecos::ECOSSolver solver(socp);
+        solver.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(1.5, -0.5)).cwiseAbs().maxCoeff() < 1e-5);
+    }
+
+    OptimizationProblem nonconvex;
+    VectorX y = nonconvex.addVariable("y", 2);
+    nonconvex.addConstraint(box(-1., y, 1.));
+    nonconvex.addCostTerm(-1. * norm1(y));
+    REQUIRE_THROWS(osqp::OSQPSolver(nonconvex));
+}
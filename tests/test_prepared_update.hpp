@@ -0,0 +1,94 @@
+using namespace cvx;
+
+TEST_CASE("Prepared update")
+{
+    { // QP
+        double a = 1.;
+
+        OptimizationProblem qp;
+        VectorX x = qp.addVariable("x", 2);
+        qp.addConstraint(lessThan(x(1), 0.5));
+        qp.addCostTerm(square(x(0) - dynpar(a)) + square(x(1) - dynpar(a)));
+
+        osqp::OSQPSolver solver(qp);
+        solver.setEpsAbs(1e-5);
+        solver.setEpsRel(1e-5);
+
+        // The prepared data is used even though the parameter has changed
+        solver.prepareUpdate();
+        a = 2.;
+        REQUIRE(solver.solve());
+        REQUIRE(eval(x(0)) == Approx(1.).margin(1e-3));
+
+        // Without prepared data the parameters are evaluated
+        REQUIRE(solver.solve());
+        REQUIRE(eval(x(0)) == Approx(2.).margin(1e-3));
+
+        // Preparing again replaces the data that has not been used yet
+        a = 7.;
+        solver.prepareUpdate();
+        a = 8.;
+        solver.prepareUpdate();
+        a = 9.;
+        REQUIRE(solver.solve());
+        REQUIRE(eval(x(0)) == Approx(8.).margin(1e-3));
+
+        // solveAsync() takes the prepared data right away
+        solver.prepareUpdate();
+        std::future<bool> claimed = solver.solveAsync();
+        a = 2.;
+        solver.prepareUpdate();
+        REQUIRE(claimed.get());
+        REQUIRE(eval(x(0)) == Approx(9.).margin(1e-3));
+        REQUIRE(solver.solve());
+        REQUIRE(eval(x(0)) == Approx(2.).margin(1e-3));
+
+        // Prepare the next instance while the current one is solved
+        a = 3.;
+        solver.prepareUpdate();
+        for (double next : {4., 5., 6.})
+        {
+            std::future<bool> result = solver.solveAsync();
+            a = next;
+            std::future<void> prepared = solver.prepareUpdateAsync();
+            REQUIRE(result.get());
+            REQUIRE(eval(x(0)) == Approx(next - 1.).margin(1e-3));
+            REQUIRE(eval(x(1)) == Approx(0.5).margin(1e-3));
+            prepared.get();
+        }
+        REQUIRE(solver.solve());
+        REQUIRE(eval(x(0)) == Approx(6.).margin(1e-3));
+
+        // New constraints discard the prepared data
+        solver.prepareUpdate();
+        a = 0.;
+        qp.addConstraint(greaterThan(x(0), -1.));
+        solver.addNewConstraints();
+        REQUIRE(solver.solve());
+        REQUIRE(eval(x(0)) == Approx(0.).margin(1e-3));
+    }
+    { // SOCP
+        double a = 1.;
+
+        OptimizationProblem socp;
+        Scalar x = socp.addVariable("x");
+        socp.addConstraint(lessThan(x, dynpar(a)));
+        socp.addCostTerm(-x);
+
+        ecos::ECOSSolver solver(socp);
+
+        solver.prepareUpdate();
+        a = 2.;
+        REQUIRE(solver.solve());
+        REQUIRE(eval(x) == Approx(1.).margin(1e-5));
+
+        for (double next : {3., 4.})
+        {
+            a = next;
+            solver.prepareUpdate();
+            a = next + 10.;
+            REQUIRE(solver.solve());
+            REQUIRE(eval(x) == Approx(next).margin(1e-5));
+        }
+    }
+}
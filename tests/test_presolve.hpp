@@ -0,0 +1,134 @@
+using namespace cvx;
+
+TEST_CASE("Presolve QP")
+{
+    size_t T = 7;
+
+    Eigen::MatrixXd A(2, 2);
+    A << 2, -1, 1, 0.2;
+    Eigen::MatrixXd B(2, 1);
+    B << 1, 0;
+    Eigen::VectorXd x0(2);
+    x0 << 3, 1;
+
+    OptimizationProblem qp;
+    MatrixX x = qp.addVariable("x", 2, T + 1);
+    MatrixX u = qp.addVariable("u", 1, T);
+
+    for (size_t t = 0; t < T; t++)
+    {
+        qp.addConstraint(equalTo(x.col(t + 1), par(A) * x.col(t) + par(B) * u.col(t)));
+    }
+    qp.addConstraint(box(-5., x, 5.));
+    qp.addConstraint(greaterThan(u, -2.));
+    qp.addConstraint(lessThan(u, 2.));
+    qp.addConstraint(lessThan(u, 3.));
+    ConstraintHandle initial = qp.addConstraint(equalTo(x.col(0), dynpar(x0)));
+    qp.addConstraint(equalTo(x.col(T), 0.));
+    qp.addCostTerm(x.squaredNorm() + u.squaredNorm());
+
+    // Reference solutions for two initial states
+    const Eigen::Vector2d x0_first(3., 1.), x0_second(-1., 2.);
+    std::vector<Eigen::MatrixXd> x_ref, u_ref;
+    size_t num_rows;
+    {
+        osqp::OSQPSolver solver(qp);
+        num_rows = solver.getNumInequalityConstraints();
+        for (const Eigen::Vector2d &x0_value : {x0_first, x0_second})
+        {
+            x0 = x0_value;
+            solver.solve(false);
+            x_ref.push_back(eval(x));
+            u_ref.push_back(eval(u));
+        }
+    }
+
+    osqp::OSQPSolver presolved_solver(qp, true);
+
+    // The initial and final states are fixed, the input bounds are merged.
+    // The box rows of the initial state depend on x0 and are kept as a single empty row.
+    REQUIRE(presolved_solver.getNumInequalityConstraints() == 33);
+    REQUIRE(presolved_solver.getNumInequalityConstraints() < num_rows);
+
+    for (size_t i = 0; i < 2; i++)
+    {
+        // The fixed values follow the dynamic parameters
+        x0 = i == 0 ? x0_first : x0_second;
+
+        presolved_solver.solve(false);
+        REQUIRE((eval(x) - x_ref[i]).cwiseAbs().maxCoeff() < 1e-3);
+        REQUIRE((eval(u) - u_ref[i]).cwiseAbs().maxCoeff() < 1e-3);
+        REQUIRE((eval(x.col(0)) - x0).cwiseAbs().maxCoeff() < 1e-9);
+        REQUIRE(presolved_solver.isFeasible(1e-3));
+    }
+
+    // Fixing rows are not part of the solver problem anymore
+    initial.disable();
+    REQUIRE_THROWS(presolved_solver.solve(false));
+    initial.enable();
+
+    qp.addConstraint(lessThan(u.sum(), 1.));
+    REQUIRE_THROWS(presolved_solver.addNewConstraints());
+}
+
+TEST_CASE("Presolve SOCP")
+{
+    OptimizationProblem socp;
+    VectorX x = socp.addVariable("x", 3);
+    double x2 = 0.5;
+
+    socp.addConstraint(equalTo(x(2), dynpar(x2)));
+    socp.addConstraint(lessThan(x.head(2).norm(), x(2) + 1.));
+    socp.addConstraint(greaterThan(x(0), -1.));
+    socp.addConstraint(greaterThan(2. * x(0), -1.));
+    socp.addConstraint(greaterThan(x(0) + x(1), -2.));
+    socp.addConstraint(greaterThan(x(0) + x(1), -1.));
+    socp.addCostTerm(x(0) + 2. * x(1));
+
+    std::vector<Eigen::VectorXd> x_ref;
+    {
+        ecos::ECOSSolver solver(socp);
+        for (double x2_value : {0.5, 2.})
+        {
+            x2 = x2_value;
+            solver.solve(false);
+            x_ref.push_back(eval(x));
+        }
+    }
+
+    ecos::ECOSSolver presolved_solver(socp, true);
+
+    REQUIRE(presolved_solver.getNumEqualityConstraints() == 0);
+    REQUIRE(presolved_solver.getNumPositiveConstraints() == 2);
+    REQUIRE(presolved_solver.getNumCones() == 1);
+
+    for (size_t i = 0; i < 2; i++)
+    {
+        x2 = i == 0 ? 0.5 : 2.;
+
+        presolved_solver.solve(false);
+        REQUIRE((eval(x) - x_ref[i]).cwiseAbs().maxCoeff() < 1e-5);
+        REQUIRE(eval(x(2)) == Approx(x2));
+        REQUIRE(presolved_solver.isFeasible(1e-5));
+    }
+}
+
+TEST_CASE("Presolve infeasible")
+{
+    // The bound of the fixed variable can not hold, so the empty row has to stay
+    OptimizationProblem qp;
+    Scalar x = qp.addVariable("x");
+    Scalar y = qp.addVariable("y");
+    qp.addConstraint(equalTo(x, 1.));
+    qp.addConstraint(greaterThan(x, 2.));
+    qp.addConstraint(box(-1., y, 1.));
+    qp.addCostTerm(x * x + y * y);
+
+    osqp::OSQPSolver solver(qp, true);
+    solver.setMaxIter(1000);
+    REQUIRE(solver.getNumInequalityConstraints() == 2);
+
+    solver.solve(false);
+    REQUIRE(solver.getInfo().status_val != OSQP_SOLVED);
+    REQUIRE_FALSE(solver.isFeasible(1e-6));
+}
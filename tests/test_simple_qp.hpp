@@ -215,3 +215,140 @@ TEST_CASE("Non-convex QP")
     std::cout << qp << "\n";
     REQUIRE_THROWS(osqp::OSQPSolver(qp));
 }
+
+TEST_CASE("Cone constraints QP")
+{
+    {
+        OptimizationProblem qp;
+        VectorX x = qp.addVariable("x", 2);
+        Scalar t = qp.addVariable("t");
+        qp.addConstraint(lessThan(x.squaredNorm(), t));
+        qp.addCostTerm(t);
+        REQUIRE_THROWS(osqp::OSQPSolver(qp));
+    }
+    {
+        OptimizationProblem qp;
+        VectorX x = qp.addVariable("x", 2);
+        qp.addConstraint(lessThan(x.norm(), 1.));
+        qp.addCostTerm(x.sum());
+        REQUIRE_THROWS(osqp::OSQPSolver(qp));
+    }
+    {
+        // Cone constraints added later are rejected as well
+        OptimizationProblem qp;
+        VectorX x = qp.addVariable("x", 2);
+        qp.addCostTerm(x.squaredNorm());
+        osqp::OSQPSolver solver(qp);
+
+        qp.addConstraint(lessThan(x.norm(), 1.));
+        REQUIRE_THROWS(solver.addNewConstraints());
+    }
+}
+
+TEST_CASE("Lifted squares QP")
+{
+    Eigen::MatrixXd F(3, 5);
+    F << 1.2, -0.4, 0.3, 2.1, -1.0,
+        0.5, 1.5, -0.7, 0.2, 0.9,
+        -1.1, 0.6, 1.4, -0.3, 0.8;
+    Eigen::Vector3d g(1., -2., 0.5);
+    double sqrt_weight = 0.3;
+
+    OptimizationProblem qp;
+    VectorX x = qp.addVariable("x", 5);
+
+    // The residuals are replaced with auxiliary variables
+    qp.addCostTerm((par(F) * x - par(g)).squaredNorm() + (dynpar(sqrt_weight) * x).squaredNorm());
+
+    osqp::OSQPSolver solver(qp);
+    solver.setEpsAbs(1e-7);
+    solver.setEpsRel(1e-7);
+
+    REQUIRE(solver.getNumVariables() == 5 + 3);
+    REQUIRE(solver.getNumInequalityConstraints() == 3);
+
+    for (double w : {0.3, 2.})
+    {
+        sqrt_weight = w;
+        const double weight = w * w;
+        solver.solve(false);
+
+        const Eigen::MatrixXd H = F.transpose() * F + weight * Eigen::MatrixXd::Identity(5, 5);
+        const Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> ldlt(H.sparseView());
+        const Eigen::VectorXd x_sol = ldlt.solve(F.transpose() * g);
+
+        REQUIRE((eval(x) - x_sol).cwiseAbs().maxCoeff() < 1e-4);
+        REQUIRE(qp.getOptimalValue() == Approx((F * x_sol - g).squaredNorm() + weight * x_sol.squaredNorm()).epsilon(1e-4));
+    }
+}
+
+TEST_CASE("Quadratic form QP")
+{
+    Eigen::Matrix3d Q;
+    Q << 4., 1., 0.,
+        1., 3., -0.5,
+        0., -0.5, 2.;
+    Eigen::SparseMatrix<double> Q_sparse = Q.sparseView();
+    const Eigen::Vector3d c(1., -1., 0.5);
+
+    OptimizationProblem qp;
+    VectorX x = qp.addVariable("x", 3);
+    qp.addConstraint(equalTo(x.sum(), 1.));
+    qp.addConstraint(box(-1., x, 1.));
+
+    // Reference with the products expanded
+    OptimizationProblem qp_ref;
+    VectorX x_ref = qp_ref.addVariable("x", 3);
+    qp_ref.addConstraint(equalTo(x_ref.sum(), 1.));
+    qp_ref.addConstraint(box(-1., x_ref, 1.));
+
+    SECTION("Constant sparse matrix")
+    {
+        qp.addCostTerm(quad_form(x, par(Q_sparse)) + par(c).dot(x));
+        qp_ref.addCostTerm(x_ref.transpose() * par(Q) * x_ref + par(c).dot(x_ref));
+    }
+    SECTION("Shifted vector")
+    {
+        qp.addCostTerm(quad_form(x - par(c), par(Q)));
+        qp_ref.addCostTerm((x_ref - par(c)).transpose() * par(Q) * (x_ref - par(c)));
+    }
+
+    Eigen::Vector3d x_sol;
+    double value;
+    {
+        osqp::OSQPSolver solver(qp_ref);
+        solver.solve(false);
+        x_sol = eval(x_ref);
+        value = qp_ref.getOptimalValue();
+    }
+
+    osqp::OSQPSolver solver(qp);
+    solver.solve(false);
+    REQUIRE((eval(x) - x_sol).cwiseAbs().maxCoeff() < 1e-3);
+    REQUIRE(qp.getOptimalValue() == Approx(value).epsilon(1e-3));
+}
+
+TEST_CASE("Dynamic quadratic form QP")
+{
+    Eigen::Matrix2d Q;
+    Q << 2., 0.5,
+        0.5, 1.;
+
+    OptimizationProblem qp;
+    VectorX x = qp.addVariable("x", 2);
+    qp.addConstraint(equalTo(x.sum(), 1.));
+    qp.addCostTerm(quad_form(x, dynpar(Q)));
+
+    osqp::OSQPSolver solver(qp);
+
+    for (double q11 : {1., 4.})
+    {
+        Q(1, 1) = q11;
+        solver.solve(false);
+
+        // Minimizer of x' * Q * x subject to x0 + x1 == 1
+        const double x0 = (Q(1, 1) - Q(0, 1)) / (Q(0, 0) + Q(1, 1) - 2. * Q(0, 1));
+        REQUIRE(eval(x(0)) == Approx(x0).margin(1e-3));
+        REQUIRE(eval(x(1)) == Approx(1. - x0).margin(1e-3));
+    }
+}
@@ -111,4 +111,183 @@ TEST_CASE("Simple SOCP")
 
     std::cout << "Solution after changing the cost function:\n"
               << x_eval << "\n\n";
-}
\ No newline at end of file
+}
+TEST_CASE("Norm2 SOCP")
+{
+    const size_t T = 20;
+
+    Eigen::MatrixXd target(2, T);
+    target.setRandom();
+
+    // One cone per column and one cone per row of u
+    auto formulate = [&](OptimizationProblem &socp, bool vector_atoms) {
+        MatrixX u = socp.addVariable("u", 2, T);
+        VectorX s = socp.addVariable("s", T);
+        VectorX r = socp.addVariable("r", 2);
+
+        if (vector_atoms)
+        {
+            socp.addConstraint(lessThan(colwiseNorm2(u - par(target)), s));
+            socp.addConstraint(lessThan(rowwiseNorm2(u), r));
+        }
+        else
+        {
+            for (size_t t = 0; t < T; t++)
+            {
+                socp.addConstraint(lessThan((u.col(t) - par(target.col(t))).norm(), s(t)));
+            }
+            for (size_t i = 0; i < 2; i++)
+            {
+                socp.addConstraint(lessThan(u.row(i).norm(), r(i)));
+            }
+        }
+        socp.addConstraint(lessThan(norm2(u.col(0)), 0.5));
+        socp.addCostTerm(s.sum() + 0.1 * r.sum());
+        return u;
+    };
+
+    Eigen::MatrixXd u_ref;
+    {
+        OptimizationProblem socp;
+        MatrixX u = formulate(socp, false);
+        ecos::ECOSSolver solver(socp);
+        solver.solve(false);
+        u_ref = eval(u);
+    }
+
+    OptimizationProblem socp;
+    MatrixX u = formulate(socp, true);
+    ecos::ECOSSolver solver(socp);
+    REQUIRE(solver.getNumCones() == T + 2 + 1);
+
+    solver.solve(false);
+    REQUIRE(solver.isFeasible(1e-8));
+    REQUIRE((eval(u) - u_ref).cwiseAbs().maxCoeff() < 1e-5);
+    REQUIRE(eval(u.col(0)).norm() <= 0.5 + 1e-6);
+}
+
+TEST_CASE("Rotated cone SOCP")
+{
+    OptimizationProblem socp;
+    VectorX x = socp.addVariable("x", 2);
+    Scalar t = socp.addVariable("t");
+    Scalar s = socp.addVariable("s");
+
+    // ||x - c||^2 <= t * s
+    const Eigen::Vector2d c(1., 1.);
+    socp.addConstraint(lessThan((x - par(c)).squaredNorm(), t * s));
+    socp.addConstraint(lessThan(s, 2.));
+    socp.addConstraint(greaterThan(x(0), 3.));
+    // Quadratic-over-linear: x(1)^2 <= t
+    socp.addConstraint(lessThan(x(1) * x(1), t));
+    socp.addCostTerm(t);
+
+    ecos::ECOSSolver solver(socp);
+    REQUIRE(solver.getNumCones() == 2);
+
+    solver.solve(false);
+    REQUIRE(solver.isFeasible(1e-8));
+    REQUIRE(eval(x(0)) == Approx(3.));
+    REQUIRE(eval(x(1)) == Approx(1.).margin(1e-5));
+    REQUIRE(eval(s) == Approx(2.));
+    REQUIRE(eval(t) == Approx(2.));
+}
+
+TEST_CASE("Dynamic data SOCP")
+{
+    // G, h, A and b mix constant and dynamic entries
+    double a = 1.;
+    double r = 2.;
+    double e = 0.5;
+
+    auto build = [&](OptimizationProblem &socp) {
+        VectorX x = socp.addVariable("x", 3);
+        socp.addConstraint(lessThan(dynpar(a) * x(0) + 2. * x(1) - x(2), 3.));
+        socp.addConstraint(lessThan((x.head(2) - par(Eigen::Vector2d(1., -1.))).norm(), dynpar(r) + x(2)));
+        socp.addConstraint(box(-2., x, dynpar(r) + 1.));
+        socp.addConstraint(equalTo(x(0) + dynpar(a) * x(2), dynpar(e)));
+        socp.addCostTerm(-x(0) - 2. * x(1) + 0.5 * x(2));
+        return x;
+    };
+
+    OptimizationProblem socp;
+    VectorX x = build(socp);
+    ecos::ECOSSolver solver(socp);
+
+    for (const Eigen::Vector3d &values : {Eigen::Vector3d(1., 2., 0.5),
+                                          Eigen::Vector3d(-0.5, 1., 0.),
+                                          Eigen::Vector3d(2., 3., 1.),
+                                          Eigen::Vector3d(1., 2., 0.5)})
+    {
+        a = values(0);
+        r = values(1);
+        e = values(2);
+        REQUIRE(solver.solve(false));
+
+        OptimizationProblem fresh_socp;
+        VectorX fresh_x = build(fresh_socp);
+        ecos::ECOSSolver fresh_solver(fresh_socp);
+        REQUIRE(fresh_solver.solve(false));
+
+        REQUIRE(solver.isFeasible(1e-6));
+        REQUIRE((eval(x) - eval(fresh_x)).cwiseAbs().maxCoeff() < 1e-6);
+    }
+}
+
+TEST_CASE("Quadratic cost SOCP")
+{
+    Eigen::MatrixXd Q(3, 3);
+    Q << 4, 1, 0,
+        1, 2, 0.5,
+        0, 0.5, 1;
+    Eigen::MatrixXd F(2, 3);
+    F << 1, 2, 0,
+        0, 1, -1;
+    Eigen::Vector3d q(1, -1, 2);
+
+    auto formulate = [&](OptimizationProblem &op) {
+        VectorX x = op.addVariable("x", 3);
+        op.addConstraint(equalTo(x.sum(), 1.));
+        op.addConstraint(box(-1., x, 1.));
+        // Expanded products, quadratic forms and squares
+        op.addCostTerm(x.transpose() * par(Q) * x + par(q).dot(x));
+        op.addCostTerm(quad_form(x, par(Q)));
+        op.addCostSlotTerm("squares", (par(F) * x - par(Eigen::Vector2d(1., 2.))).squaredNorm());
+        return x;
+    };
+
+    std::vector<Eigen::VectorXd> x_ref;
+    {
+        OptimizationProblem qp;
+        VectorX x = formulate(qp);
+        osqp::OSQPSolver solver(qp);
+        for (double weight : {1., 3.})
+        {
+            qp.setCostSlotWeight("squares", weight);
+            solver.solve(false);
+            x_ref.push_back(eval(x));
+        }
+    }
+
+    OptimizationProblem socp;
+    VectorX x = formulate(socp);
+    ecos::ECOSSolver solver(socp);
+
+    // One epigraph cone for the cost term and one for the slot
+    REQUIRE(solver.getNumCones() == 2);
+
+    for (size_t i = 0; i < 2; i++)
+    {
+        socp.setCostSlotWeight("squares", i == 0 ? 1. : 3.);
+        solver.solve(false);
+        REQUIRE(solver.isFeasible(1e-8));
+        REQUIRE((eval(x) - x_ref[i]).cwiseAbs().maxCoeff() < 1e-3);
+    }
+
+    // Non-convex costs are rejected
+    OptimizationProblem nonconvex;
+    VectorX y = nonconvex.addVariable("y", 2);
+    nonconvex.addConstraint(box(-1., y, 1.));
+    nonconvex.addCostTerm(y(0) * y(1));
+    REQUIRE_THROWS(ecos::ECOSSolver(nonconvex));
+}
@@ -56,3 +56,48 @@ TEST_CASE("getVariable")
     REQUIRE_THROWS(op.getVariable("imaginary_vector", vector_returned));
     REQUIRE_THROWS(op.getVariable("imaginary_matrix", matrix_returned));
 }
+
+TEST_CASE("Structured matrix variables")
+{
+    Eigen::Matrix3d target;
+    target << 1, 2, 3,
+        4, 5, 6,
+        7, 8, 9;
+
+    OptimizationProblem qp;
+    MatrixX symmetric = qp.addSymmetricVariable("symmetric", 3);
+    MatrixX diagonal = qp.addDiagonalVariable("diagonal", 3);
+    Eigen::SparseMatrix<double> pattern = Eigen::MatrixXd(target.triangularView<Eigen::Lower>()).sparseView();
+    MatrixX lower = qp.addVariable("lower", pattern);
+
+    REQUIRE_THROWS(qp.addSymmetricVariable("symmetric", 3));
+    REQUIRE_THROWS(qp.addDiagonalVariable("symmetric", 3));
+    REQUIRE_THROWS(qp.addVariable("symmetric", pattern));
+
+    // Mirrored entries are the same variable, the other entries are constant
+    REQUIRE(symmetric(0, 2) == symmetric(2, 0));
+    REQUIRE(diagonal(0, 1).getOrder() == 0);
+    REQUIRE(lower(0, 2).getOrder() == 0);
+    REQUIRE(lower(2, 0).getOrder() == 1);
+
+    qp.addCostTerm((symmetric - par(target)).squaredNorm() +
+                   (diagonal - par(target)).squaredNorm() +
+                   (lower - par(target)).squaredNorm());
+
+    osqp::OSQPSolver solver(qp);
+    REQUIRE(solver.getNumVariables() == 6 + 3 + 6);
+
+    solver.solve(false);
+
+    Eigen::MatrixXd symmetric_eval, diagonal_eval, lower_eval;
+    qp.getVariableValue("symmetric", symmetric_eval);
+    qp.getVariableValue("diagonal", diagonal_eval);
+    qp.getVariableValue("lower", lower_eval);
+
+    const Eigen::Matrix3d symmetric_target = 0.5 * (target + target.transpose());
+    const Eigen::Matrix3d diagonal_target = target.diagonal().asDiagonal();
+    const Eigen::Matrix3d lower_target = target.triangularView<Eigen::Lower>();
+    REQUIRE((symmetric_eval - symmetric_target).cwiseAbs().maxCoeff() < 1e-3);
+    REQUIRE((diagonal_eval - diagonal_target).cwiseAbs().maxCoeff() < 1e-3);
+    REQUIRE((lower_eval - lower_target).cwiseAbs().maxCoeff() < 1e-3);
+}
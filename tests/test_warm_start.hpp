@@ -0,0 +1,47 @@
+using namespace cvx;
+
+TEST_CASE("Warm start")
+{
+    for (bool presolve : {false, true})
+    {
+        auto build = [](OptimizationProblem &qp, ConstraintHandle &upper) {
+            VectorX x = qp.addVariable("x", 2);
+            Scalar t = qp.addVariable("t");
+
+            upper = qp.addConstraint(lessThan(x, 1.));
+            qp.addConstraint(box(-10., t, 10.));
+            qp.addCostTerm(x.squaredNorm() - 8. * x.sum() + square(t - 1.));
+            return x;
+        };
+
+        OptimizationProblem qp;
+        ConstraintHandle upper;
+        VectorX x = build(qp, upper);
+
+        osqp::OSQPSolver cold(qp, presolve);
+        cold.setCheckTermination(1);
+        cold.solve(false);
+        REQUIRE((eval(x) - Eigen::Vector2d(1., 1.)).cwiseAbs().maxCoeff() < 1e-2);
+
+        OptimizationProblem qp_warm;
+        ConstraintHandle upper_warm;
+        VectorX x_warm = build(qp_warm, upper_warm);
+
+        osqp::OSQPSolver warm(qp_warm, presolve);
+        warm.setCheckTermination(1);
+
+        // Stationarity: 2x - 8 + y = 0
+        warm.warmStart("x", Eigen::VectorXd(Eigen::Vector2d(1., 1.)));
+        warm.warmStart("t", 1.);
+        warm.warmStart(upper_warm, Eigen::VectorXd(Eigen::Vector2d(6., 6.)));
+        warm.solve(false);
+
+        REQUIRE((eval(x_warm) - Eigen::Vector2d(1., 1.)).cwiseAbs().maxCoeff() < 1e-2);
+        REQUIRE(warm.getInfo().iter < cold.getInfo().iter);
+
+        REQUIRE_THROWS(warm.warmStart("x", Eigen::VectorXd(Eigen::VectorXd::Zero(3))));
+        REQUIRE_THROWS(warm.warmStart("y", Eigen::VectorXd(Eigen::VectorXd::Zero(2))));
+        REQUIRE_THROWS(warm.warmStart(upper_warm, Eigen::VectorXd(Eigen::VectorXd::Zero(3))));
+        REQUIRE_THROWS(warm.warmStart(upper, Eigen::VectorXd(Eigen::VectorXd::Zero(2))));
+    }
+}